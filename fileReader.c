@@ -1,7 +1,12 @@
 #include "postgres.h"
+
+#include <fcntl.h>
 #include "catalog/pg_type.h"
+#include "mb/pg_wchar.h"
+#include "nodes/value.h"
 #include "storage/fd.h"
 #include "utils/lsyscache.h"
+#include "utils/typcache.h"
 
 #include "orc_fdw.h"
 #include "orc.pb-c.h"
@@ -11,7 +16,19 @@
 #include "inputStream.h"
 
 /* forward declarations of static functions */
-static int StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *columns);
+static int StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *columns,
+		List *subfieldPathList, List *mapKeyList);
+static void MapFieldReaderSetKeys(MapFieldReader *mapReader, List *mapKeyList, int columnNo);
+static int MapItemReaderAllocate(FieldReader *itemReader, FieldReader *mapField, Footer *footer,
+		int orcColumnNo, Oid psqlType);
+static Oid MapValuePSQLType(FieldType__Kind kind);
+static List * ChildSubfieldPathList(List *subfieldPathList, int fieldNo, bool *referenced);
+static int FieldReaderAllocateHelper(FieldReader *field, Footer *footer, List *subfieldPathList);
+static void PrimitiveFieldReaderAllocate(FieldReader *field);
+static FieldReader * FieldReaderFindColumn(FieldReader *fieldReader, int orcColumnNo);
+static void FieldReaderPrefetch(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
+		StripeFooter *stripeFooter);
+static void FieldReaderSeekHelper(FieldReader *fieldReader, int strideIndex);
 static int FieldReaderInitHelper(FieldReader *fieldReader, FILE *file, long *currentDataOffset,
 		int *streamNo, StripeFooter *stripeFooter, CompressionParameters *parameters);
 static bool MatchOrcWithPSQL(FieldType__Kind orcType, Oid psqlType);
@@ -250,11 +267,14 @@ StripeFooterInit(FILE *file, StripeInformation *stripeInfo, CompressionParameter
  * Allocates memory and sets initial types/values for the variables of a field reader
  *
  * @param query list of required columns and their propertiesss
+ * @param subfieldPathList paths of the referenced sub-fields of struct columns
+ * @param mapKeyList keys of the map columns if only some keys are used, see MapFieldReaderSetKeys
  *
  * @return
  */
 int 
-FieldReaderAllocate(FieldReader *reader, Footer *footer, List *columns)
+FieldReaderAllocate(FieldReader *reader, Footer *footer, List *columns, List *subfieldPathList,
+		List *mapKeyList)
 {
 	reader->orcColumnNo = 0;
 	reader->hasPresentBitReader = 0;
@@ -262,12 +282,15 @@ FieldReaderAllocate(FieldReader *reader, Footer *footer, List *columns)
 	reader->required = 1;
 	reader->psqlVariable = NULL;
 	reader->rowIndex = NULL;
+	reader->strideMode = STRIDE_MODE_NORMAL;
+	reader->readFunction = NULL;
 	reader->presentBitReader.stream = NULL;
 
 	reader->fieldReader = alloc(sizeof(StructFieldReader));
 
 	/* allocate memory for the row as a structure reader */
-	return StructFieldReaderAllocate((StructFieldReader *) reader->fieldReader, footer, columns);
+	return StructFieldReaderAllocate((StructFieldReader *) reader->fieldReader, footer, columns,
+			subfieldPathList, mapKeyList);
 }
 
 
@@ -324,6 +347,10 @@ MatchOrcWithPSQL(FieldType__Kind orcType, Oid psqlType)
 			break;
 		}
 		case NUMERICOID:
+		{
+			matches = orcType == FIELD_TYPE__KIND__DECIMAL;
+			break;
+		}
 		case TIMESTAMPTZOID:
 		default:
 		{
@@ -340,29 +367,29 @@ MatchOrcWithPSQL(FieldType__Kind orcType, Oid psqlType)
  *
  * @param reader structure to store the reader information
  * @param footer orc file footer
- * @param selectedFields an array of bytes which contains either 0 or 1 to specify the needed fields
+ * @param columns list of required columns sorted by their index
+ * @param subfieldPathList referenced sub-field paths of the columns, see ChildSubfieldPathList
+ * @param mapKeyList keys of the map columns used in the query
  *
  * @return 0 for success and -1 for failure
  */
 static int 
-StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *columns)
+StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *columns,
+		List *subfieldPathList, List *mapKeyList)
 {
 	FieldType **types = footer->types;
 	FieldType *root = footer->types[0];
-	FieldType *type = NULL;
-	PrimitiveFieldReader *primitiveReader = NULL;
-	ListFieldReader *listReader = NULL;
 	FieldReader *field = NULL;
 	ListCell *listCell = NULL;
 	Var *variable = NULL;
 	int readerIterator = 0;
-	int streamIterator = 0;
-	int queryColumnIterator = 0;
-	int arrayItemPSQLKind = 0;
-	bool typesMatch = false;
+	int result = 0;
 
 	reader->noOfFields = root->n_subtypes;
 	reader->fields = alloc(sizeof(FieldReader *) * reader->noOfFields);
+	reader->tupleDescriptor = NULL;
+	reader->values = NULL;
+	reader->nulls = NULL;
 	listCell = list_head(columns);
 
 	/* list may be empty, like in the case of "select count( *) from table_name" */
@@ -374,15 +401,19 @@ StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *colum
 	/* for each column in the row, create readers if they are required in the query */
 	for (readerIterator = 0; readerIterator < reader->noOfFields; ++readerIterator)
 	{
+		List *childPathList = NIL;
+		bool referenced = false;
+
 		/* create field reader definitions for all fields */
 		reader->fields[readerIterator] = alloc(sizeof(FieldReader));
 		field = reader->fields[readerIterator];
 		field->orcColumnNo = root->subtypes[readerIterator];
-		type = types[root->subtypes[readerIterator]];
-		field->kind = type->kind;
+		field->kind = types[field->orcColumnNo]->kind;
 		field->hasPresentBitReader = 0;
 		field->presentBitReader.stream = NULL;
 		field->rowIndex = NULL;
+		field->strideMode = STRIDE_MODE_NORMAL;
+		field->readFunction = NULL;
 
 		/* requested columns are sorted according to their index, we can trust its order */
 		if (listCell != NULL && (variable->varattno - 1) == readerIterator)
@@ -395,7 +426,10 @@ StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *colum
 			{
 				variable = (Var *) lfirst(listCell);
 			}
-			queryColumnIterator++;
+
+			/* if sub-fields of the column are not known, the whole column is read */
+			childPathList = ChildSubfieldPathList(subfieldPathList, readerIterator + 1,
+					&referenced);
 		}
 		else
 		{
@@ -403,14 +437,106 @@ StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *colum
 			field->psqlVariable = NULL;
 		}
 
-		if (field->kind == FIELD_TYPE__KIND__LIST)
+		result = FieldReaderAllocateHelper(field, footer, childPathList);
+		if (result)
+		{
+			return result;
+		}
+
+		/* maps which are only used through their keys keep just those entries */
+		if (field->required && field->kind == FIELD_TYPE__KIND__MAP && !referenced)
+		{
+			MapFieldReaderSetKeys((MapFieldReader *) field->fieldReader, mapKeyList,
+					readerIterator + 1);
+		}
+	}
+
+	if (listCell != NULL)
+	{
+		LogError("Table definition has more columns than the ORC file");
+	}
+
+	return 0;
+}
+
+
+/*
+ * Returns the paths of the sub-fields referenced under the given field. Each path is
+ * a list of field numbers starting from 1, from the outermost field to the innermost
+ * one. NIL means that the whole field is needed, which is also the case if nothing
+ * is known about its sub-fields.
+ *
+ * @param subfieldPathList paths under the parent field
+ * @param fieldNo field number in the parent field
+ * @param referenced set to true if the field is referenced by any of the paths
+ */
+static List *
+ChildSubfieldPathList(List *subfieldPathList, int fieldNo, bool *referenced)
+{
+	List *childPathList = NIL;
+	ListCell *pathCell = NULL;
+	bool wholeField = false;
+
+	*referenced = false;
+
+	foreach(pathCell, subfieldPathList)
+	{
+		List *path = (List *) lfirst(pathCell);
+
+		if (linitial_int(path) != fieldNo)
+		{
+			continue;
+		}
+
+		*referenced = true;
+
+		if (list_length(path) == 1)
 		{
+			wholeField = true;
+		}
+		else
+		{
+			childPathList = lappend(childPathList, list_copy_tail(path, 1));
+		}
+	}
+
+	return wholeField ? NIL : childPathList;
+}
+
+
+/*
+ * Allocates the reader of a field whose kind, column no, required flag and PostgreSQL
+ * variable are already set. Struct fields allocate their sub-fields recursively; only
+ * the sub-fields on the given paths are marked as required.
+ *
+ * @return 0 for success and -1 for failure
+ */
+static int
+FieldReaderAllocateHelper(FieldReader *field, Footer *footer, List *subfieldPathList)
+{
+	FieldType **types = footer->types;
+	FieldType *type = types[field->orcColumnNo];
+	bool typesMatch = false;
+
+	switch (field->kind)
+	{
+		case FIELD_TYPE__KIND__LIST:
+		{
+			ListFieldReader *listReader = NULL;
 			FieldReader *listItemReader = NULL;
+			Oid elementType = InvalidOid;
+			int result = 0;
 
 			field->fieldReader = alloc(sizeof(ListFieldReader));
 
 			listReader = field->fieldReader;
 			listReader->lengthReader.stream = NULL;
+			listReader->itemType = InvalidOid;
+			listReader->hasFixedWidthItems = 0;
+			listReader->itemValues = NULL;
+			listReader->itemNulls = NULL;
+			listReader->itemValuesSize = 0;
+			listReader->itemBatch = NULL;
 
 			/* initialize list item reader */
 			listItemReader = &listReader->itemReader;
@@ -420,60 +546,211 @@ StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *colum
 			listItemReader->orcColumnNo = type->subtypes[0];
 			listItemReader->kind = types[listItemReader->orcColumnNo]->kind;
 			listItemReader->rowIndex = NULL;
+			listItemReader->strideMode = STRIDE_MODE_NORMAL;
+			listItemReader->readFunction = NULL;
+			listItemReader->psqlVariable = NULL;
 
 			if (listItemReader->required)
 			{
+				elementType = get_element_type(field->psqlVariable->vartype);
+
+				/*
+				 * PostgreSQL arrays don't have a separate type for each dimension, so
+				 * nested lists are read with the array type of the column itself.
+				 */
 				listItemReader->psqlVariable = alloc(sizeof(Var));
 				memset(listItemReader->psqlVariable, 0, sizeof(Var));
-				listItemReader->psqlVariable->vartype = get_element_type(
-						field->psqlVariable->vartype);
+				listItemReader->psqlVariable->vartype =
+						(listItemReader->kind == FIELD_TYPE__KIND__LIST) ?
+						field->psqlVariable->vartype : elementType;
 
-				typesMatch = MatchOrcWithPSQL(listItemReader->kind, OrcGetPSQLType(listItemReader));
-				if (listItemReader->psqlVariable->vartype == InvalidOid || !typesMatch)
+				typesMatch = IsComplexType(listItemReader->kind) ||
+						MatchOrcWithPSQL(listItemReader->kind, OrcGetPSQLType(listItemReader));
+				if (elementType == InvalidOid || !typesMatch)
 				{
 					LogError3(
 							"Error occurred while reading column %d: ORC and PSQL types do not match, ORC type is %s[]",
 							field->orcColumnNo, GetTypeKindName(listItemReader->kind));
 				}
 			}
-			else
+
+			/* list items are allocated as any other field, they are read as a whole */
+			result = FieldReaderAllocateHelper(listItemReader, footer, NIL);
+			if (result)
 			{
-				listItemReader->psqlVariable = NULL;
+				return result;
 			}
 
-			if (IsComplexType(listItemReader->kind))
+			if (listItemReader->required)
 			{
-				/* only list of primitive types is supported */
-				LogError("Only lists of primitive types are supported currently");
-				return -1;
+				listReader->itemType = elementType;
+				get_typlenbyvalalign(elementType, &listReader->itemTypeLength,
+						&listReader->itemTypeByValue, &listReader->itemTypeAlignment);
+
+				listReader->itemValuesSize = DEFAULT_LIST_ITEM_COUNT;
+				listReader->itemValues = alloc(sizeof(Datum) * listReader->itemValuesSize);
+				listReader->itemNulls = alloc(sizeof(bool) * listReader->itemValuesSize);
+
+				/* integers and floating points of the same width are copied into arrays as they are */
+				if (IsComplexType(listItemReader->kind))
+				{
+					listReader->hasFixedWidthItems = 0;
+				}
+				else if (elementType == INT2OID || elementType == INT4OID || elementType == INT8OID)
+				{
+					listReader->hasFixedWidthItems = 1;
+					listReader->itemBatch = alloc(sizeof(uint64_t) * STRING_BATCH_SIZE);
+				}
+				else if ((elementType == FLOAT4OID && listItemReader->kind == FIELD_TYPE__KIND__FLOAT) ||
+						(elementType == FLOAT8OID && listItemReader->kind == FIELD_TYPE__KIND__DOUBLE))
+				{
+					listReader->hasFixedWidthItems = 1;
+				}
 			}
+			break;
+		}
+		case FIELD_TYPE__KIND__STRUCT:
+		{
+			StructFieldReader *structReader = NULL;
+			TupleDesc tupleDescriptor = NULL;
+			int fieldIndex = 0;
+			int result = 0;
 
-			listItemReader->fieldReader = alloc(sizeof(PrimitiveFieldReader));
-			primitiveReader = listItemReader->fieldReader;
+			field->fieldReader = alloc(sizeof(StructFieldReader));
 
-			primitiveReader->hasDictionary = 0;
-			primitiveReader->dictionary = NULL;
-			primitiveReader->dictionarySize = 0;
-			primitiveReader->wordLength = NULL;
+			structReader = field->fieldReader;
+			structReader->noOfFields = type->n_subtypes;
+			structReader->fields = alloc(sizeof(FieldReader *) * structReader->noOfFields);
+			structReader->tupleDescriptor = NULL;
+			structReader->values = NULL;
+			structReader->nulls = NULL;
 
-			for (streamIterator = 0; streamIterator < MAX_STREAM_COUNT; ++streamIterator)
+			/* struct fields are read as composite types with the same fields in the same order */
+			if (field->required)
 			{
-				primitiveReader->readers[streamIterator].stream = NULL;
+				if (!type_is_rowtype(OrcGetPSQLType(field)))
+				{
+					LogError3(
+							"Error occurred while reading column %d: ORC and PSQL types do not match, ORC type is %s",
+							field->orcColumnNo, GetTypeKindName(field->kind));
+				}
+
+				tupleDescriptor = lookup_rowtype_tupdesc_copy(OrcGetPSQLType(field),
+						OrcGetPSQLTypeMod(field));
+
+				if (tupleDescriptor->natts != structReader->noOfFields)
+				{
+					LogError2("Composite type of column %d has a different number of fields than the ORC struct",
+							field->orcColumnNo);
+				}
+
+				structReader->tupleDescriptor = tupleDescriptor;
+				structReader->values = alloc(sizeof(Datum) * structReader->noOfFields);
+				structReader->nulls = alloc(sizeof(bool) * structReader->noOfFields);
+			}
+
+			for (fieldIndex = 0; fieldIndex < structReader->noOfFields; ++fieldIndex)
+			{
+				FieldReader *subfield = alloc(sizeof(FieldReader));
+				List *childPathList = NIL;
+				bool referenced = false;
+
+				structReader->fields[fieldIndex] = subfield;
+				subfield->orcColumnNo = type->subtypes[fieldIndex];
+				subfield->kind = types[subfield->orcColumnNo]->kind;
+				subfield->hasPresentBitReader = 0;
+				subfield->presentBitReader.stream = NULL;
+				subfield->rowIndex = NULL;
+				subfield->strideMode = STRIDE_MODE_NORMAL;
+				subfield->readFunction = NULL;
+				subfield->psqlVariable = NULL;
+
+				childPathList = ChildSubfieldPathList(subfieldPathList, fieldIndex + 1, &referenced);
+				subfield->required = field->required && (subfieldPathList == NIL || referenced);
+
+				if (subfield->required)
+				{
+					Form_pg_attribute attribute = tupleDescriptor->attrs[fieldIndex];
+
+					if (attribute->attisdropped)
+					{
+						LogError2("Composite type of column %d has dropped fields", field->orcColumnNo);
+					}
+
+					subfield->psqlVariable = alloc(sizeof(Var));
+					memset(subfield->psqlVariable, 0, sizeof(Var));
+					subfield->psqlVariable->varattno = fieldIndex + 1;
+					subfield->psqlVariable->vartype = attribute->atttypid;
+					subfield->psqlVariable->vartypmod = attribute->atttypmod;
+				}
+
+				result = FieldReaderAllocateHelper(subfield, footer, childPathList);
+				if (result)
+				{
+					return result;
+				}
 			}
+
+			break;
+		}
+		case FIELD_TYPE__KIND__MAP:
+		{
+			MapFieldReader *mapReader = alloc(sizeof(MapFieldReader));
+			Oid valueType = MapValuePSQLType(types[type->subtypes[1]]->kind);
+			int result = 0;
+
+			field->fieldReader = mapReader;
+			mapReader->lengthReader.stream = NULL;
+			mapReader->keyCount = 0;
+			mapReader->keys = NULL;
+			mapReader->buffer.data = NULL;
+
+			/*
+			 * Maps are read as json objects, so only string keys and scalar values are
+			 * supported. Other maps can still be skipped when they are not required.
+			 */
+			if (field->required)
+			{
+				if (types[type->subtypes[0]]->kind != FIELD_TYPE__KIND__STRING ||
+						valueType == InvalidOid)
+				{
+					LogError("Only maps with string keys and primitive values are supported currently");
+					return -1;
+				}
+
+				if (OrcGetPSQLType(field) != JSONOID && OrcGetPSQLType(field) != TEXTOID)
+				{
+					LogError3(
+							"Error occurred while reading column %d: ORC and PSQL types do not match, ORC type is %s",
+							field->orcColumnNo, GetTypeKindName(field->kind));
+				}
+
+				initStringInfo(&mapReader->buffer);
+			}
+
+			result = MapItemReaderAllocate(&mapReader->keyReader, field, footer,
+					type->subtypes[0], TEXTOID);
+			if (result == 0)
+			{
+				result = MapItemReaderAllocate(&mapReader->valueReader, field, footer,
+						type->subtypes[1], valueType);
+			}
+
+			return result;
 		}
-		else if (field->kind == FIELD_TYPE__KIND__STRUCT || field->kind == FIELD_TYPE__KIND__MAP)
+		case FIELD_TYPE__KIND__UNION:
 		{
-			/* struct and map fields are not supported */
+			/* union fields are not supported */
 			LogError2("%s kind in ORC files aren't supported", GetTypeKindName(field->kind));
 			return -1;
 		}
-		else
+		default:
 		{
 			/* initializers for primitive column types */
 			if (field->required)
 			{
 				typesMatch = MatchOrcWithPSQL(field->kind, OrcGetPSQLType(field));
-				if (arrayItemPSQLKind != InvalidOid || !typesMatch)
+				if (!typesMatch)
 				{
 					LogError3(
 							"Error occurred while reading column %d: ORC and PSQL types do not match, ORC type is %s",
@@ -481,41 +758,166 @@ StructFieldReaderAllocate(StructFieldReader *reader, Footer *footer, List *colum
 				}
 			}
 
-			field->fieldReader = alloc(sizeof(PrimitiveFieldReader));
+			PrimitiveFieldReaderAllocate(field);
+			break;
+		}
+	}
 
-			primitiveReader = field->fieldReader;
-			primitiveReader->hasDictionary = 0;
-			primitiveReader->dictionary = NULL;
-			primitiveReader->dictionarySize = 0;
-			primitiveReader->wordLength = NULL;
+	return 0;
+}
 
-			for (streamIterator = 0; streamIterator < MAX_STREAM_COUNT; ++streamIterator)
-			{
-				primitiveReader->readers[streamIterator].stream = NULL;
-			}
+
+/*
+ * Allocates the key or value reader of a map. They are read with the given PostgreSQL
+ * type and are required if the map is.
+ */
+static int
+MapItemReaderAllocate(FieldReader *itemReader, FieldReader *mapField, Footer *footer,
+		int orcColumnNo, Oid psqlType)
+{
+	itemReader->required = mapField->required;
+	itemReader->hasPresentBitReader = 0;
+	itemReader->presentBitReader.stream = NULL;
+	itemReader->orcColumnNo = orcColumnNo;
+	itemReader->kind = footer->types[orcColumnNo]->kind;
+	itemReader->rowIndex = NULL;
+	itemReader->strideMode = STRIDE_MODE_NORMAL;
+	itemReader->readFunction = NULL;
+	itemReader->psqlVariable = NULL;
+
+	if (itemReader->required)
+	{
+		itemReader->psqlVariable = alloc(sizeof(Var));
+		memset(itemReader->psqlVariable, 0, sizeof(Var));
+		itemReader->psqlVariable->vartype = psqlType;
+		itemReader->psqlVariable->vartypmod = -1;
+	}
+	else
+	{
+		/* items of maps which are not read may be of any kind, they are only skipped */
+		return FieldReaderAllocateHelper(itemReader, footer, NIL);
+	}
+
+	PrimitiveFieldReaderAllocate(itemReader);
+
+	return 0;
+}
+
+
+/*
+ * Returns the PostgreSQL type used to read the map values of the given kind, or
+ * InvalidOid if the values of the kind can't be written into a json object.
+ */
+static Oid
+MapValuePSQLType(FieldType__Kind kind)
+{
+	switch (kind)
+	{
+		case FIELD_TYPE__KIND__BOOLEAN:
+			return BOOLOID;
+		case FIELD_TYPE__KIND__SHORT:
+			return INT2OID;
+		case FIELD_TYPE__KIND__INT:
+			return INT4OID;
+		case FIELD_TYPE__KIND__LONG:
+			return INT8OID;
+		case FIELD_TYPE__KIND__FLOAT:
+			return FLOAT4OID;
+		case FIELD_TYPE__KIND__DOUBLE:
+			return FLOAT8OID;
+		case FIELD_TYPE__KIND__STRING:
+			return TEXTOID;
+		default:
+			return InvalidOid;
+	}
+}
+
+
+/*
+ * Sets the keys of a map column which are used in the query. Each item of the key
+ * list is a pair of the column's attribute number and the key. If no keys are found
+ * for the column, the whole map is read.
+ */
+static void
+MapFieldReaderSetKeys(MapFieldReader *mapReader, List *mapKeyList, int columnNo)
+{
+	ListCell *mapKeyCell = NULL;
+
+	foreach(mapKeyCell, mapKeyList)
+	{
+		List *mapKey = (List *) lfirst(mapKeyCell);
+
+		if (intVal(linitial(mapKey)) != columnNo)
+		{
+			continue;
+		}
+
+		if (mapReader->keys == NULL)
+		{
+			mapReader->keys = alloc(sizeof(char *) * list_length(mapKeyList));
 		}
+
+		mapReader->keys[mapReader->keyCount] = pstrdup(strVal(lsecond(mapKey)));
+		mapReader->keyCount++;
 	}
+}
 
-	if (listCell != NULL)
+/*
+ * Allocates the reader of a primitive field with no streams, dictionary or batch.
+ */
+static void
+PrimitiveFieldReaderAllocate(FieldReader *field)
+{
+	PrimitiveFieldReader *primitiveReader = alloc(sizeof(PrimitiveFieldReader));
+	int streamIterator = 0;
+
+	primitiveReader->hasDictionary = 0;
+	primitiveReader->dictionaryLoaded = 0;
+	primitiveReader->dictionaryOffsets = NULL;
+	primitiveReader->dictionarySize = 0;
+	primitiveReader->dictionaryArena = NULL;
+	primitiveReader->dictionaryArenaSize = 0;
+	primitiveReader->batchValues = NULL;
+	primitiveReader->batchArena = NULL;
+	primitiveReader->batchArenaSize = 0;
+	primitiveReader->batchLength = 0;
+	primitiveReader->batchPosition = 0;
+	primitiveReader->batchSecondaryValues = NULL;
+	primitiveReader->stringMaxLength = -1;
+	primitiveReader->stringPadded = 0;
+	primitiveReader->singleByteEncoding = (pg_database_encoding_max_length() == 1);
+	primitiveReader->valueByValue = field->required ?
+			get_typbyval(OrcGetPSQLType(field)) : true;
+
+	/* length limits of CHAR(n) and VARCHAR(n) are the same for all values */
+	if (field->required && (OrcGetPSQLType(field) == BPCHAROID ||
+			OrcGetPSQLType(field) == VARCHAROID) && OrcGetPSQLTypeMod(field) >= (int32) VARHDRSZ)
 	{
-		LogError("Table definition has more columns than the ORC file");
+		primitiveReader->stringMaxLength = OrcGetPSQLTypeMod(field) - VARHDRSZ;
+		primitiveReader->stringPadded = (OrcGetPSQLType(field) == BPCHAROID);
 	}
 
-	return 0;
+	for (streamIterator = 0; streamIterator < MAX_STREAM_COUNT; ++streamIterator)
+	{
+		primitiveReader->readers[streamIterator].stream = NULL;
+	}
+
+	field->fieldReader = primitiveReader;
 }
 
 
 /*
  * Initializes a reader for the given stripe. Uses helper function FieldReaderInitHelper
- * to recursively initialize its fields.
+ * to recursively initialize its fields. Row indexes of the required columns are
+ * read only if readRowIndex is set.
  */
 int 
 FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
-		StripeFooter *stripeFooter, CompressionParameters *parameters)
+		StripeFooter *stripeFooter, CompressionParameters *parameters, bool readRowIndex)
 {
-	StructFieldReader *structReader = (StructFieldReader *) fieldReader->fieldReader;
-	FieldReader **fields = structReader->fields;
 	FieldReader *subField = NULL;
+	StructFieldReader *structReader = NULL;
+	int columnIndex = 0;
 	FileStream *indexStream = NULL;
 	Stream *stream = NULL;
 	long currentDataOffset = 0;
@@ -529,6 +931,13 @@ FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
 	currentDataOffset = stripe->offset + stripe->indexlength;
 	stream = stripeFooter->streams[streamNo];
 
+	/* modes of the strides in the previous stripe don't apply anymore */
+	structReader = (StructFieldReader *) fieldReader->fieldReader;
+	for (columnIndex = 0; columnIndex < structReader->noOfFields; ++columnIndex)
+	{
+		FieldReaderClearStrideMode(structReader->fields[columnIndex]);
+	}
+
 	if (stream->kind == STREAM__KIND__ROW_INDEX)
 	{
 		/* first index stream is for the struct field, skip it */
@@ -537,13 +946,16 @@ FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
 		stream = stripeFooter->streams[streamNo];
 	}
 
-	/* read the row index information from the file for the required columns */
+	/*
+	 * Read the row index information from the file for the required columns. Index
+	 * streams come in the column order, nested columns are found by their column no.
+	 */
 	while (streamNo < stripeFooter->n_streams && stream->kind == STREAM__KIND__ROW_INDEX)
 	{
-		subField = *fields;
-		fields++;
+		subField = FieldReaderFindColumn(fieldReader, stream->column);
 
-		if (ENABLE_ROW_SKIPPING && subField->required)
+		if (readRowIndex && subField != NULL && subField != fieldReader &&
+				subField->required)
 		{
 			/* if row is required, read its index information */
 			if (subField->rowIndex)
@@ -567,46 +979,18 @@ FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
 			FileStreamFree(indexStream);
 		}
 
-		/* if column type is list we need to take into account the index stream for the child */
-		if (subField->kind == FIELD_TYPE__KIND__LIST)
-		{
-			subField = &((ListFieldReader *) subField->fieldReader)->itemReader;
+		currentIndexOffset += stream->length;
+		streamNo++;
 
-			/* get the child's index stream */
-			currentIndexOffset += stream->length;
-			streamNo++;
+		if (streamNo < stripeFooter->n_streams)
+		{
 			stream = stripeFooter->streams[streamNo];
-
-			if (ENABLE_ROW_SKIPPING && subField->required)
-			{
-				if (subField->rowIndex)
-				{
-					row_index__free_unpacked(subField->rowIndex, NULL);
-					subField->rowIndex = NULL;
-				}
-
-				indexStream = FileStreamInit(file, currentIndexOffset,
-						currentIndexOffset + stream->length,
-						DEFAULT_ROW_INDEX_SIZE, parameters->compressionKind);
-				FileStreamReadRemaining(indexStream, &indexBuffer, &indexBufferLength);
-
-				subField->rowIndex = row_index__unpack(NULL, indexBufferLength,
-						(uint8_t *) indexBuffer);
-				if (!subField->rowIndex)
-				{
-					LogError("Error occurred while unpacking row index message");
-					return -1;
-				}
-
-				FileStreamFree(indexStream);
-			}
 		}
-
-		currentIndexOffset += stream->length;
-		streamNo++;
-		stream = stripeFooter->streams[streamNo];
 	}
 
+	/* let the kernel read the data of the required columns while we start decoding */
+	FieldReaderPrefetch(fieldReader, file, stripe, stripeFooter);
+
 	/* set offset for data reading */
 	currentDataOffset = stripe->offset + stripe->indexlength;
 
@@ -620,6 +1004,9 @@ FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
 		return -1;
 	}
 
+	/* streams of the stripe are known now, choose how each field is read */
+	FieldReaderSetReadFunction(fieldReader);
+
 	if (streamNo != stripeFooter->n_streams)
 	{
 		LogError("Invalid ORC file. ORC column count doesn't match with table definition.");	
@@ -629,6 +1016,113 @@ FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
 	return 0;
 }
 
+/*
+ * Finds the reader of the given ORC column in the reader tree.
+ *
+ * @return the reader of the column, NULL if it doesn't exist
+ */
+static FieldReader *
+FieldReaderFindColumn(FieldReader *fieldReader, int orcColumnNo)
+{
+	if (fieldReader->orcColumnNo == orcColumnNo)
+	{
+		return fieldReader;
+	}
+
+	if (fieldReader->kind == FIELD_TYPE__KIND__STRUCT)
+	{
+		StructFieldReader *structReader = (StructFieldReader *) fieldReader->fieldReader;
+		int fieldIndex = 0;
+
+		for (fieldIndex = 0; fieldIndex < structReader->noOfFields; ++fieldIndex)
+		{
+			FieldReader *subfield = structReader->fields[fieldIndex];
+
+			/* columns are numbered in pre-order, skip the sub-trees which come later */
+			if (fieldIndex + 1 < structReader->noOfFields &&
+					structReader->fields[fieldIndex + 1]->orcColumnNo <= orcColumnNo)
+			{
+				continue;
+			}
+
+			return FieldReaderFindColumn(subfield, orcColumnNo);
+		}
+	}
+	else if (fieldReader->kind == FIELD_TYPE__KIND__LIST)
+	{
+		return FieldReaderFindColumn(&((ListFieldReader *) fieldReader->fieldReader)->itemReader,
+				orcColumnNo);
+	}
+	else if (fieldReader->kind == FIELD_TYPE__KIND__MAP)
+	{
+		MapFieldReader *mapReader = (MapFieldReader *) fieldReader->fieldReader;
+		FieldReader *keyReader = FieldReaderFindColumn(&mapReader->keyReader, orcColumnNo);
+
+		return keyReader ? keyReader : FieldReaderFindColumn(&mapReader->valueReader, orcColumnNo);
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Advises the kernel that the data streams of the required columns in the stripe
+ * will be read soon. Streams of a column are read one buffer at a time as values
+ * are decoded, so without the advice the reads of different columns wait for
+ * each other. Streams next to each other are advised together.
+ */
+static void
+FieldReaderPrefetch(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
+		StripeFooter *stripeFooter)
+{
+#ifdef USE_POSIX_FADVISE
+	long streamOffset = stripe->offset;
+	long prefetchOffset = 0;
+	long prefetchLength = 0;
+	int streamNo = 0;
+
+	/* streams are stored back to back in their order in the stripe footer */
+	for (streamNo = 0; streamNo < stripeFooter->n_streams; ++streamNo)
+	{
+		Stream *stream = stripeFooter->streams[streamNo];
+		FieldReader *columnReader = NULL;
+
+		if (stream->kind != STREAM__KIND__ROW_INDEX)
+		{
+			columnReader = FieldReaderFindColumn(fieldReader, stream->column);
+		}
+
+		if (columnReader != NULL && columnReader != fieldReader && columnReader->required &&
+				stream->length > 0)
+		{
+			if (prefetchLength > 0 && prefetchOffset + prefetchLength == streamOffset)
+			{
+				prefetchLength += stream->length;
+			}
+			else
+			{
+				if (prefetchLength > 0)
+				{
+					(void) posix_fadvise(fileno(file), prefetchOffset, prefetchLength,
+							POSIX_FADV_WILLNEED);
+				}
+
+				prefetchOffset = streamOffset;
+				prefetchLength = stream->length;
+			}
+		}
+
+		streamOffset += stream->length;
+	}
+
+	if (prefetchLength > 0)
+	{
+		(void) posix_fadvise(fileno(file), prefetchOffset, prefetchLength, POSIX_FADV_WILLNEED);
+	}
+#endif
+}
+
+
 /**
  * Helper function to initialize the reader for the given stripe
  *
@@ -714,20 +1208,46 @@ FieldReaderInitHelper(FieldReader *fieldReader, FILE *file, long *currentDataOff
 				return -1;
 			}
 
-			stream = stripeFooter->streams[*streamNo];
+			/* set the readers for the child of the list */
+			return FieldReaderInitHelper(&listFieldReader->itemReader, file, currentDataOffset,
+					streamNo, stripeFooter, parameters);
+		}
+		case FIELD_TYPE__KIND__MAP:
+		{
+			MapFieldReader *mapFieldReader = fieldReader->fieldReader;
+
+			if (fieldReader->required)
+			{
+				/* get the length stream of the map field */
+				result = StreamReaderInit(&mapFieldReader->lengthReader, FIELD_TYPE__KIND__INT, file,
+						*currentDataOffset, *currentDataOffset + stream->length, parameters);
+			}
 
-			if (IsComplexType(listFieldReader->itemReader.kind))
+			if (result)
 			{
-				LogError("List of complex types complex types are not supported\n");
 				return -1;
 			}
 
-			/* set the readers for the child of the list */
-			return FieldReaderInitHelper(&listFieldReader->itemReader, file, currentDataOffset,
+			*currentDataOffset += stream->length;
+			(*streamNo)++;
+
+			if (*streamNo >= totalStreamCount)
+			{
+				LogError("Invalid ORC file. ORC column count doesn't match with table definition.");
+				return -1;
+			}
+
+			/* keys come before the values */
+			result = FieldReaderInitHelper(&mapFieldReader->keyReader, file, currentDataOffset,
+					streamNo, stripeFooter, parameters);
+			if (result)
+			{
+				return -1;
+			}
+
+			return FieldReaderInitHelper(&mapFieldReader->valueReader, file, currentDataOffset,
 					streamNo, stripeFooter, parameters);
 		}
-		case FIELD_TYPE__KIND__MAP:
-		case FIELD_TYPE__KIND__DECIMAL:
 		case FIELD_TYPE__KIND__UNION:
 		{
 			/* these are not supported yet */
@@ -754,7 +1274,7 @@ FieldReaderInitHelper(FieldReader *fieldReader, FILE *file, long *currentDataOff
 				}
 			}
 
-			return (*streamNo == totalStreamCount) ? 0 : -1;
+			return 0;
 		}
 		default:
 		{
@@ -779,30 +1299,48 @@ FieldReaderInitHelper(FieldReader *fieldReader, FILE *file, long *currentDataOff
 				primitiveFieldReader->hasDictionary = (columnEncoding->kind ==
 						COLUMN_ENCODING__KIND__DICTIONARY);
 
-				/* if field's type is string, (re)initialize dictionary */
-				if (primitiveFieldReader->dictionary)
+				/*
+				 * If field's type is string, (re)initialize dictionary. Its items are read
+				 * on the first access, here we only make sure that there is enough room
+				 * for their offsets.
+				 */
+				primitiveFieldReader->dictionaryLoaded = 0;
+
+				if (fieldReader->required && primitiveFieldReader->hasDictionary)
 				{
-					int dictionaryIterator = 0;
+					primitiveFieldReader->dictionarySize = columnEncoding->dictionarysize;
 
-					for (dictionaryIterator = 0; dictionaryIterator < primitiveFieldReader->dictionarySize;
-							++dictionaryIterator)
+					if (primitiveFieldReader->dictionaryOffsets == NULL)
+					{
+						primitiveFieldReader->dictionaryOffsets =
+								alloc(sizeof(int) * (primitiveFieldReader->dictionarySize + 1));
+						primitiveFieldReader->dictionaryArenaSize = VARHDRSZ;
+						primitiveFieldReader->dictionaryArena =
+								alloc(primitiveFieldReader->dictionaryArenaSize);
+					}
+					else
 					{
-						freeMemory(primitiveFieldReader->dictionary[dictionaryIterator]);
+						primitiveFieldReader->dictionaryOffsets =
+								reAllocateMemory(primitiveFieldReader->dictionaryOffsets,
+										sizeof(int) * (primitiveFieldReader->dictionarySize + 1));
 					}
-					freeMemory(primitiveFieldReader->dictionary);
-					freeMemory(primitiveFieldReader->wordLength);
-					primitiveFieldReader->dictionary = NULL;
-					primitiveFieldReader->wordLength = NULL;
 				}
-
-				if (fieldReader->required)
+				else
 				{
-					primitiveFieldReader->dictionarySize = columnEncoding->dictionarysize;
+					primitiveFieldReader->dictionarySize = 0;
 				}
-				else if (primitiveFieldReader)
+
+				/* direct encoded strings are decoded in batches */
+				if (fieldReader->required && !primitiveFieldReader->hasDictionary &&
+						primitiveFieldReader->batchValues == NULL)
 				{
-					primitiveFieldReader->dictionarySize = 0;
+					primitiveFieldReader->batchValues = alloc(sizeof(Datum) * STRING_BATCH_SIZE);
+					primitiveFieldReader->batchArenaSize = DEFAULT_STRING_BATCH_ARENA_SIZE;
+					primitiveFieldReader->batchArena = alloc(primitiveFieldReader->batchArenaSize);
 				}
+
+				primitiveFieldReader->batchLength = 0;
+				primitiveFieldReader->batchPosition = 0;
 			}
 			else if (columnEncoding->kind != COLUMN_ENCODING__KIND__DIRECT)
 			{
@@ -811,6 +1349,26 @@ FieldReaderInitHelper(FieldReader *fieldReader, FILE *file, long *currentDataOff
 				return -1;
 			}
 
+			/*
+			 * Dates and timestamps are decoded in batches if 64 bit datums are passed by
+			 * value, as their batch values first hold the raw 64 bit integers.
+			 */
+			if (fieldReader->required && primitiveFieldReader->batchValues == NULL &&
+					FLOAT8PASSBYVAL && (fieldReader->kind == FIELD_TYPE__KIND__DATE ||
+					fieldReader->kind == FIELD_TYPE__KIND__TIMESTAMP))
+			{
+				primitiveFieldReader->batchValues = alloc(sizeof(Datum) * STRING_BATCH_SIZE);
+
+				if (fieldReader->kind == FIELD_TYPE__KIND__TIMESTAMP)
+				{
+					primitiveFieldReader->batchSecondaryValues =
+							alloc(sizeof(uint64_t) * STRING_BATCH_SIZE);
+				}
+			}
+
+			primitiveFieldReader->batchLength = 0;
+			primitiveFieldReader->batchPosition = 0;
+
 			dataStreamCount = GetStreamCount(fieldReader->kind, columnEncoding->kind);
 
 			/* check if there exists enough stream for the current field */
@@ -841,12 +1399,6 @@ FieldReaderInitHelper(FieldReader *fieldReader, FILE *file, long *currentDataOff
 				stream = stripeFooter->streams[*streamNo];
 			}
 
-			/* fill the dictionary if the field has one */
-			if (primitiveFieldReader->hasDictionary)
-			{
-				FillDictionary(fieldReader);
-			}
-
 			return 0;
 		}
 	}
@@ -862,87 +1414,141 @@ void
 FieldReaderSeek(FieldReader *rowReader, int strideIndex)
 {
 	StructFieldReader *structReader = (StructFieldReader  *) rowReader->fieldReader;
-	FieldReader *subfield = NULL;
-	RowIndex *rowIndex = NULL;
-	RowIndexEntry *rowIndexEntry = NULL;
-	OrcStack *stack = NULL;
 	int columnIndex = 0;
 
 	for (columnIndex = 0; columnIndex < structReader->noOfFields; ++columnIndex)
 	{
-		subfield = structReader->fields[columnIndex];
+		FieldReader *subfield = structReader->fields[columnIndex];
 
 		if (subfield->required)
 		{
-			rowIndex = subfield->rowIndex;
-			rowIndexEntry = rowIndex->entry[strideIndex];
-			stack = OrcStackInit(rowIndexEntry->positions, sizeof(uint64_t),
-					rowIndexEntry->n_positions);
+			/* mode of the previous stride doesn't apply after the seek */
+			FieldReaderClearStrideMode(subfield);
+			FieldReaderSetReadFunction(subfield);
 
-			if (subfield->hasPresentBitReader)
-			{
-				StreamReaderSeek(&subfield->presentBitReader, subfield->kind,
-						FIELD_TYPE__KIND__BOOLEAN, stack);
-			}
+			FieldReaderSeekHelper(subfield, strideIndex);
+		}
+	}
+}
 
-			switch (subfield->kind)
-			{
-			case FIELD_TYPE__KIND__LIST:
-			{
-				/* set the length reader of the list column reader */
-				StreamReaderSeek(&((ListFieldReader *) subfield->fieldReader)->lengthReader,
-						subfield->kind, FIELD_TYPE__KIND__INT, stack);
 
-				/* set the subfield as the list item reader and skip its content */
-				subfield = &((ListFieldReader *) subfield->fieldReader)->itemReader;
+/*
+ * Sets how each required column is read in the given stride, see
+ * FieldReaderSetStrideMode. Columns must be at the start of the stride.
+ *
+ * @param strideIndex index of the stride in the stripe
+ * @param strideRowCount no of rows in the stride
+ */
+void
+FieldReaderSetStrideModes(FieldReader *rowReader, int strideIndex, long strideRowCount)
+{
+	StructFieldReader *structReader = (StructFieldReader  *) rowReader->fieldReader;
+	int columnIndex = 0;
 
-				rowIndex = subfield->rowIndex;
-				rowIndexEntry = rowIndex->entry[strideIndex];
-				stack = OrcStackInit(rowIndexEntry->positions, sizeof(uint64_t),
-						rowIndexEntry->n_positions);
+	for (columnIndex = 0; columnIndex < structReader->noOfFields; ++columnIndex)
+	{
+		FieldReader *subfield = structReader->fields[columnIndex];
 
-				if (subfield->hasPresentBitReader)
-				{
-					StreamReaderSeek(&subfield->presentBitReader, subfield->kind,
-							FIELD_TYPE__KIND__BOOLEAN, stack);
-				}
+		if (subfield->required)
+		{
+			FieldReaderSetStrideMode(subfield, strideIndex, strideRowCount);
+		}
+	}
+}
 
-				/* continue to the default case to jump in the child (which should be of primitive type) streams */
-			}
-			default:
-			{
-				PrimitiveFieldReader *primitiveFieldReader = (PrimitiveFieldReader *) subfield->fieldReader;
-				FieldType__Kind streamKind = 0;
-				int dataStreamCount = 0;
-				int dataStreamIndex = 0;
 
-				dataStreamCount = GetStreamCount(subfield->kind, primitiveFieldReader->encoding);
+/*
+ * Seeks the streams of a field to the given stride using the positions in its row
+ * index entry. Children of lists and structs have their own row indexes.
+ */
+static void
+FieldReaderSeekHelper(FieldReader *subfield, int strideIndex)
+{
+	RowIndex *rowIndex = subfield->rowIndex;
+	RowIndexEntry *rowIndexEntry = rowIndex->entry[strideIndex];
+	OrcStack *stack = OrcStackInit(rowIndexEntry->positions, sizeof(uint64_t),
+			rowIndexEntry->n_positions);
 
-				for (dataStreamIndex = 0; dataStreamIndex < dataStreamCount;
-						++dataStreamIndex)
-				{
-					/*
-					 * When dictionary encoding is used for strings, we only make a jump in the
-					 * data stream which is the integer stream for the dictionary item position.
-					 */
-					if ((subfield->kind == FIELD_TYPE__KIND__STRING) && 
-						(primitiveFieldReader->encoding == COLUMN_ENCODING__KIND__DICTIONARY) && 
-						(dataStreamIndex != DATA_STREAM))
-					{
-						continue;
-					}
+	if (subfield->hasPresentBitReader)
+	{
+		StreamReaderSeek(&subfield->presentBitReader, subfield->kind,
+				FIELD_TYPE__KIND__BOOLEAN, stack);
+	}
 
-					streamKind = GetStreamKind(subfield->kind, primitiveFieldReader->encoding,
-							dataStreamIndex);
-					StreamReaderSeek(&primitiveFieldReader->readers[dataStreamIndex],
-							subfield->kind, streamKind, stack);
-				}
+	switch (subfield->kind)
+	{
+	case FIELD_TYPE__KIND__LIST:
+	{
+		ListFieldReader *listReader = (ListFieldReader *) subfield->fieldReader;
+
+		/* set the length reader of the list column reader */
+		StreamReaderSeek(&listReader->lengthReader, subfield->kind, FIELD_TYPE__KIND__INT, stack);
+
+		/* then jump in the child streams */
+		FieldReaderSeekHelper(&listReader->itemReader, strideIndex);
+		break;
+	}
+	case FIELD_TYPE__KIND__MAP:
+	{
+		MapFieldReader *mapReader = (MapFieldReader *) subfield->fieldReader;
+
+		StreamReaderSeek(&mapReader->lengthReader, subfield->kind, FIELD_TYPE__KIND__INT, stack);
+
+		FieldReaderSeekHelper(&mapReader->keyReader, strideIndex);
+		FieldReaderSeekHelper(&mapReader->valueReader, strideIndex);
+		break;
+	}
+	case FIELD_TYPE__KIND__STRUCT:
+	{
+		StructFieldReader *structReader = (StructFieldReader *) subfield->fieldReader;
+		int fieldIndex = 0;
+
+		for (fieldIndex = 0; fieldIndex < structReader->noOfFields; ++fieldIndex)
+		{
+			if (structReader->fields[fieldIndex]->required)
+			{
+				FieldReaderSeekHelper(structReader->fields[fieldIndex], strideIndex);
 			}
+		}
+		break;
+	}
+	default:
+	{
+		PrimitiveFieldReader *primitiveFieldReader = (PrimitiveFieldReader *) subfield->fieldReader;
+		FieldType__Kind streamKind = 0;
+		int dataStreamCount = 0;
+		int dataStreamIndex = 0;
+
+		dataStreamCount = GetStreamCount(subfield->kind, primitiveFieldReader->encoding);
+
+		/* values decoded ahead belong to the previous position, discard them */
+		primitiveFieldReader->batchLength = 0;
+		primitiveFieldReader->batchPosition = 0;
+
+		for (dataStreamIndex = 0; dataStreamIndex < dataStreamCount;
+				++dataStreamIndex)
+		{
+			/*
+			 * When dictionary encoding is used for strings, we only make a jump in the
+			 * data stream which is the integer stream for the dictionary item position.
+			 */
+			if ((subfield->kind == FIELD_TYPE__KIND__STRING) && 
+				(primitiveFieldReader->encoding == COLUMN_ENCODING__KIND__DICTIONARY) && 
+				(dataStreamIndex != DATA_STREAM))
+			{
+				continue;
 			}
 
-			OrcStackFree(stack);
+			streamKind = GetStreamKind(subfield->kind, primitiveFieldReader->encoding,
+					dataStreamIndex);
+			StreamReaderSeek(&primitiveFieldReader->readers[dataStreamIndex],
+					subfield->kind, streamKind, stack);
 		}
+		break;
 	}
+	}
+
+	OrcStackFree(stack);
 }
 
 
@@ -954,17 +1560,31 @@ PrimitiveFieldReaderFree(PrimitiveFieldReader *reader)
 {
 	int index = 0;
 
-	if (reader->dictionary)
+	if (reader->dictionaryOffsets)
 	{
-		for (index = 0; index < reader->dictionarySize; ++index)
-		{
-			freeMemory(reader->dictionary[index]);
-		}
-		freeMemory(reader->dictionary);
-		freeMemory(reader->wordLength);
+		freeMemory(reader->dictionaryOffsets);
+		freeMemory(reader->dictionaryArena);
 
-		reader->dictionary = NULL;
-		reader->wordLength = NULL;
+		reader->dictionaryOffsets = NULL;
+		reader->dictionaryArena = NULL;
+	}
+
+	if (reader->batchValues)
+	{
+		freeMemory(reader->batchValues);
+		reader->batchValues = NULL;
+	}
+
+	if (reader->batchArena)
+	{
+		freeMemory(reader->batchArena);
+		reader->batchArena = NULL;
+	}
+
+	if (reader->batchSecondaryValues)
+	{
+		freeMemory(reader->batchSecondaryValues);
+		reader->batchSecondaryValues = NULL;
 	}
 
 	for (index = 0; index < MAX_STREAM_COUNT; ++index)
@@ -998,6 +1618,14 @@ StructFieldReaderFree(StructFieldReader *structReader)
 		}
 		freeMemory(subField);
 	}
+
+	if (structReader->tupleDescriptor)
+	{
+		FreeTupleDesc(structReader->tupleDescriptor);
+		freeMemory(structReader->values);
+		freeMemory(structReader->nulls);
+	}
+
 	freeMemory(structReader->fields);
 	freeMemory(structReader);
 }
@@ -1043,13 +1671,48 @@ FieldReaderFree(FieldReader *reader)
 			listReader = (ListFieldReader *) reader->fieldReader;
 			StreamReaderFree(&listReader->lengthReader);
 			FieldReaderFree(&listReader->itemReader);
+
+			if (listReader->itemValues)
+			{
+				freeMemory(listReader->itemValues);
+				freeMemory(listReader->itemNulls);
+			}
+			if (listReader->itemBatch)
+			{
+				freeMemory(listReader->itemBatch);
+			}
 			freeMemory(listReader);
 			break;
 		}
-		case FIELD_TYPE__KIND__DECIMAL:
+		case FIELD_TYPE__KIND__MAP:
+		{
+			MapFieldReader *mapReader = (MapFieldReader *) reader->fieldReader;
+
+			StreamReaderFree(&mapReader->lengthReader);
+			FieldReaderFree(&mapReader->keyReader);
+			FieldReaderFree(&mapReader->valueReader);
+
+			if (mapReader->keys)
+			{
+				int keyIndex = 0;
+
+				for (keyIndex = 0; keyIndex < mapReader->keyCount; ++keyIndex)
+				{
+					freeMemory(mapReader->keys[keyIndex]);
+				}
+				freeMemory(mapReader->keys);
+			}
+
+			if (mapReader->buffer.data)
+			{
+				freeMemory(mapReader->buffer.data);
+			}
+
+			freeMemory(mapReader);
+			break;
+		}
+		case FIELD_TYPE__KIND__UNION:
 		{
-			case FIELD_TYPE__KIND__UNION:
-			case FIELD_TYPE__KIND__MAP:
 			return -1;
 		}
 		default:
@@ -20,10 +20,12 @@ PostScript * PostScriptInit(FILE *file, long *postScriptSizeOffset, CompressionP
 Footer * FileFooterInit(FILE *file, long footerOffset, long footerSize, CompressionParameters *parameters);
 StripeFooter * StripeFooterInit(FILE *file, StripeInformation *stripeInfo, CompressionParameters *parameters);
 
-int FieldReaderAllocate(FieldReader *reader, Footer *footer, List *columns);
+int FieldReaderAllocate(FieldReader *reader, Footer *footer, List *columns, List *subfieldPathList,
+		List *mapKeyList);
 int FieldReaderInit(FieldReader *fieldReader, FILE *file, StripeInformation *stripe,
-		StripeFooter *stripeFooter, CompressionParameters *parameters);
+		StripeFooter *stripeFooter, CompressionParameters *parameters, bool readRowIndex);
 void FieldReaderSeek(FieldReader *rowReader, int strideNo);
+void FieldReaderSetStrideModes(FieldReader *rowReader, int strideIndex, long strideRowCount);
 int FieldReaderFree(FieldReader *reader);
 
 #endif /* FILEREADER_H_ */
@@ -13,11 +13,12 @@
 
 
 /*
- * Resets a file buffer with the new data positions
+ * Resets a file buffer with the new file and data positions
  */
 static void
-FileBufferReset(FileBuffer *fileBuffer, long offset, long limit, int bufferSize)
+FileBufferReset(FileBuffer *fileBuffer, FILE *file, long offset, long limit, int bufferSize)
 {
+	fileBuffer->file = file;
 	fileBuffer->offset = offset;
 
 	if(fileBuffer->bufferSize < bufferSize)
@@ -329,10 +330,12 @@ FileBufferSkip(FileBuffer *fileBuffer, long offset)
 }
 
 /*
- * Resets the file stream with the new parameters
+ * Resets the file stream with the new parameters. The file may differ from the
+ * one the stream is initialized with, so buffers are reused across files.
  */
 void
-FileStreamReset(FileStream *stream, long offset, long limit, int bufferSize, CompressionKind kind)
+FileStreamReset(FileStream *stream, FILE *file, long offset, long limit, int bufferSize,
+		CompressionKind kind)
 {
 	/* when uncompressed files are used, buffer size is set to ORC's default size */
 	if (kind == COMPRESSION_KIND__NONE)
@@ -347,7 +350,7 @@ FileStreamReset(FileStream *stream, long offset, long limit, int bufferSize, Com
 		stream->data = stream->allocatedMemory;
 	}
 
-	FileBufferReset(stream->fileBuffer, offset, limit, stream->bufferSize);
+	FileBufferReset(stream->fileBuffer, file, offset, limit, stream->bufferSize);
 
 	stream->compressionKind = kind;
 
@@ -804,6 +807,136 @@ FileStreamReadRemaining(FileStream *stream, char **data, int *dataLength)
 }
 
 
+/**
+ * Makes sure that there are unread bytes in memory and returns them. For
+ * uncompressed streams these are the bytes in the file buffer, else they are
+ * the bytes of the current uncompressed block.
+ *
+ * @param stream stream to read
+ * @param data used to return the start of the unread bytes
+ *
+ * @return no of unread bytes in memory, 0 at the end of the stream, -1 for failure
+ */
+static int
+FileStreamNextBytes(FileStream *stream, char **data)
+{
+	if (stream->compressionKind == COMPRESSION_KIND__NONE)
+	{
+		FileBuffer *fileBuffer = stream->fileBuffer;
+
+		if (fileBuffer->position >= fileBuffer->length && FileBufferFill(fileBuffer) < 0)
+		{
+			return -1;
+		}
+
+		*data = fileBuffer->buffer + fileBuffer->position;
+		return fileBuffer->length - fileBuffer->position;
+	}
+
+	if (stream->length == 0 || stream->position == stream->length)
+	{
+		if (FileBufferBytesLeft(stream->fileBuffer) == 0)
+		{
+			return 0;
+		}
+
+		if (ReadNextCompressedBlock(stream))
+		{
+			LogError("Error reading compressed stream header\n");
+			return -1;
+		}
+	}
+
+	*data = stream->data + stream->position;
+	return stream->length - stream->position;
+}
+
+
+/**
+ * Marks the given number of bytes returned by FileStreamNextBytes as read.
+ */
+static void
+FileStreamConsume(FileStream *stream, int length)
+{
+	if (stream->compressionKind == COMPRESSION_KIND__NONE)
+	{
+		stream->fileBuffer->position += length;
+	}
+	else
+	{
+		stream->position += length;
+	}
+}
+
+
+/**
+ * Skips the given number of bytes in the stream without copying them.
+ *
+ * @param stream stream to skip in
+ * @param byteCount no of bytes to skip
+ *
+ * @return 0 for success, -1 for failure
+ */
+int
+FileStreamSkipBytes(FileStream *stream, long byteCount)
+{
+	while (byteCount > 0)
+	{
+		char *data = NULL;
+		int availableLength = FileStreamNextBytes(stream, &data);
+		int skipLength = 0;
+
+		if (availableLength <= 0)
+		{
+			return -1;
+		}
+
+		skipLength = (int) Min(byteCount, (long) availableLength);
+		FileStreamConsume(stream, skipLength);
+		byteCount -= skipLength;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Skips the given number of base 128 variable length integers in the stream.
+ * Integers are not decoded, only their last bytes which have the high bit
+ * cleared are counted.
+ *
+ * @param stream stream to skip in
+ * @param integerCount no of integers to skip
+ *
+ * @return 0 for success, -1 for failure
+ */
+int
+FileStreamSkipVarInts(FileStream *stream, long integerCount)
+{
+	while (integerCount > 0)
+	{
+		char *data = NULL;
+		int availableLength = FileStreamNextBytes(stream, &data);
+		int byteIndex = 0;
+
+		if (availableLength <= 0)
+		{
+			return -1;
+		}
+
+		while (byteIndex < availableLength && integerCount > 0)
+		{
+			integerCount -= ((data[byteIndex] & 0x80) == 0);
+			byteIndex++;
+		}
+
+		FileStreamConsume(stream, byteIndex);
+	}
+
+	return 0;
+}
+
+
 /**
  * Checks whether file stream is ended.
  *
@@ -87,12 +87,15 @@ typedef struct
  * Methods for using a file stream.
  */
 FileStream * FileStreamInit(FILE *file, long offset, long limit, int bufferSize, CompressionKind kind);
-void FileStreamReset(FileStream *stream, long offset, long limit, int bufferSize, CompressionKind kind);
+void FileStreamReset(FileStream *stream, FILE *file, long offset, long limit, int bufferSize,
+		CompressionKind kind);
 int FileStreamFree(FileStream *fileStream);
 char * FileStreamRead(FileStream *fileStream, int *length);
 int FileStreamReadByte(FileStream *fileStream, char *value);
 int FileStreamReadRemaining(FileStream *fileStream, char **data, int *dataLength);
 void FileStreamSkip(FileStream *fileStream, OrcStack *stack);
+int FileStreamSkipBytes(FileStream *fileStream, long byteCount);
+int FileStreamSkipVarInts(FileStream *fileStream, long integerCount);
 int FileStreamEOF(FileStream *fileStream);
 
 #endif /* INPUTSTREAM_H_ */
@@ -0,0 +1,14 @@
+/* contrib/orc_fdw/orc_fdw--1.0--1.1.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION orc_fdw UPDATE TO '1.1'" to load this file. \quit
+
+CREATE FUNCTION orc_fdw_column_statistics(foreign_table regclass, column_name text,
+    OUT row_count bigint, OUT value_count bigint,
+    OUT min_value text, OUT max_value text, OUT sum_value text)
+RETURNS record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT;
+
+-- statistics show the values of the column, so callers are granted access explicitly
+REVOKE ALL ON FUNCTION orc_fdw_column_statistics(regclass, text) FROM PUBLIC;
@@ -0,0 +1,28 @@
+/* contrib/orc_fdw/orc_fdw--1.1.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION orc_fdw" to load this file. \quit
+
+CREATE FUNCTION orc_fdw_handler()
+RETURNS fdw_handler
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT;
+
+CREATE FUNCTION orc_fdw_validator(text[], oid)
+RETURNS void
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT;
+
+CREATE FOREIGN DATA WRAPPER orc_fdw
+  HANDLER orc_fdw_handler
+  VALIDATOR orc_fdw_validator;
+
+CREATE FUNCTION orc_fdw_column_statistics(foreign_table regclass, column_name text,
+    OUT row_count bigint, OUT value_count bigint,
+    OUT min_value text, OUT max_value text, OUT sum_value text)
+RETURNS record
+AS 'MODULE_PATHNAME'
+LANGUAGE C STRICT;
+
+-- statistics show the values of the column, so callers are granted access explicitly
+REVOKE ALL ON FUNCTION orc_fdw_column_statistics(regclass, text) FROM PUBLIC;
@@ -14,18 +14,26 @@
 #include "postgres.h"
 #include "orc_fdw.h"
 
+#include <ctype.h>
+#include <fcntl.h>
+#include <glob.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include "access/heapam.h"
 #include "access/reloptions.h"
 #include "catalog/pg_foreign_table.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
 #include "commands/explain.h"
 #include "commands/vacuum.h"
+#include "executor/executor.h"
 #include "foreign/fdwapi.h"
 #include "foreign/foreign.h"
+#include "funcapi.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/plancat.h"
 #include "optimizer/pathnode.h"
@@ -35,16 +43,19 @@
 #include "optimizer/var.h"
 #include "port.h"
 #include "storage/fd.h"
+#include "utils/acl.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/date.h"
 #include "utils/datetime.h"
+#include "utils/fmgroids.h"
 #include "utils/int8.h"
 #include "utils/timestamp.h"
 #include "utils/hsearch.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
+#include "utils/typcache.h"
 
 #include "orc.pb-c.h"
 #include "fileReader.h"
@@ -65,9 +76,37 @@ static void OrcEndForeignScan(ForeignScanState *scanState);
 
 static OrcFdwOptions * OrcGetOptions(Oid foreignTableId);
 static char * OrcGetOptionValue(Oid foreignTableId, const char *optionName);
+static List * OrcFilenameList(const char *filename, List *partitionColumnList,
+		List *restrictionList, List **partitionPathOffsetList);
+static int OrcPartitionPathOffset(const char *pattern);
+static List * OrcMatchingFilenameList(const char *pattern, bool directory,
+		List *partitionColumnList, List *partitionRestrictionList, List *restrictionList);
+static int OrcParsePartitionDirectory(const char *directoryName, List *partitionColumnList,
+		Datum *value, bool *isNull);
+static List * PartitionColumnList(Oid foreignTableId, Index tableId,
+		List *partitionColumnNameList);
+static FILE * OrcOpenFile(const char *filename, PostScript **postScript, Footer **footer,
+		CompressionParameters *compressionParameters);
+static void OrcReadFileTail(FILE *file, PostScript **postScript, Footer **footer,
+		CompressionParameters *compressionParameters);
+static bool OrcFooterTypesMatch(Footer *footer, Footer *otherFooter);
+static OrcFdwPlanState * OrcPlanFiles(RelOptInfo *baserel, List *filenameList);
+static List * OrcScanFilenameList(Oid foreignTableId, ForeignScan *foreignScan,
+		List **partitionPathOffsetList);
+static bool RestrictionsRefuted(RelOptInfo *baserel);
+static bool OrcFileRefuted(Footer *footer, List *columnList, List *restrictionList);
 static double TupleCount(RelOptInfo *baserel, const char *filename);
 static BlockNumber PageCount(const char *filename);
 static List * ColumnList(RelOptInfo *baserel);
+static long RowLimit(PlannerInfo *root, RelOptInfo *baserel);
+static List * FilterClauseList(List *scanClauses, List *partitionColumnList,
+		List **otherClauseList);
+static bool FilterClauseWalker(Node *node, void *context);
+static List * QualColumnList(List *scanClauses);
+static List * SubfieldPathList(PlannerInfo *root, RelOptInfo *baserel, List **mapKeyList);
+static bool SubfieldPathWalker(Node *node, SubfieldPathContext *context);
+static void AddSubfieldPath(SubfieldPathContext *context, List *path);
+static bool AddMapKey(SubfieldPathContext *context, Oid functionId, List *argumentList);
 static bool OrcAnalyzeForeignTable(Relation relation, AcquireSampleRowsFunc *acquireSampleRowsFunc,
 		BlockNumber *totalPageCount);
 static int OrcAcquireSampleRows(Relation relation, int logLevel, HeapTuple *sampleRows,
@@ -77,14 +116,29 @@ static int OrcAcquireSampleRows(Relation relation, int logLevel, HeapTuple *samp
 /**
  * Helper functions for reading rows from the file
  */
+static void OrcInitializeScan(ForeignScanState *scanState);
+static FILE * OrcPrefetchFileTail(const char *filename);
+static void OrcOpenNextFile(OrcFdwExecState *execState);
+static void OrcSetPartitionValues(OrcFdwExecState *execState);
 static void OrcGetNextStripe(OrcFdwExecState *execState);
-static void FillTupleSlot(FieldReader *recordReader, Datum *columnValues, bool *columnNulls);
+static void OrcSetStrideModes(OrcFdwExecState *execState);
+static bool OrcMoveToNextRows(OrcFdwExecState *execState);
+static bool OrcFillBatch(ForeignScanState *scanState);
+static void OrcSelectBatchRows(ForeignScanState *scanState, uint32 rowCount);
+static void OrcFillPartitionColumns(OrcFdwExecState *execState, Datum *columnValues,
+		bool *columnNulls, int columnCount);
+static void FillColumnBatch(OrcFdwExecState *execState, bool *columnMask, bool *selection,
+		uint32 rowCount);
+static void OrcInitializeLateMaterialization(OrcFdwExecState *execState,
+		ForeignScanState *scanState, List *qualColumnList);
+static void OrcInitializeBatch(OrcFdwExecState *execState);
 
 /* Declarations for dynamic loading */
 PG_MODULE_MAGIC;
 
 PG_FUNCTION_INFO_V1(orc_fdw_handler);
 PG_FUNCTION_INFO_V1(orc_fdw_validator);
+PG_FUNCTION_INFO_V1(orc_fdw_column_statistics);
 
 
 /*
@@ -159,6 +213,17 @@ orc_fdw_validator(PG_FUNCTION_ARGS)
 		{
 			filenameFound = true;
 		}
+		else if (strncmp(optionName, OPTION_NAME_PARTITION_COLUMNS, NAMEDATALEN) == 0)
+		{
+			List *partitionColumnNameList = NIL;
+			char *partitionColumns = pstrdup(defGetString(optionDef));
+
+			if (!SplitIdentifierString(partitionColumns, ',', &partitionColumnNameList))
+			{
+				ereport(ERROR, (errcode(ERRCODE_FDW_INVALID_STRING_FORMAT),
+						errmsg("invalid list syntax for \"%s\"", optionName)));
+			}
+		}
 	}
 
 	if (optionContextId == ForeignTableRelationId)
@@ -175,6 +240,264 @@ orc_fdw_validator(PG_FUNCTION_ARGS)
 }
 
 
+/*
+ * orc_fdw_column_statistics returns the row count of the files of an orc_fdw
+ * foreign table, and the count of non-null values, the minimum, the maximum and
+ * the sum of the given column from the file statistics in their footers. No
+ * stripe is read. Values which are not kept in the statistics of every file for
+ * the column's type are returned as null. Minimum, maximum and sum are returned
+ * in text form. Minimums and maximums of strings are returned only under the C
+ * and POSIX collations, since the files order strings by their bytes. Partition
+ * columns are not in the files, so they have no statistics.
+ */
+Datum
+orc_fdw_column_statistics(PG_FUNCTION_ARGS)
+{
+	Oid foreignTableId = PG_GETARG_OID(0);
+	char *columnName = text_to_cstring(PG_GETARG_TEXT_P(1));
+	OrcFdwOptions *options = NULL;
+	TupleDesc tupleDescriptor = NULL;
+	Datum values[5];
+	bool nulls[5];
+	HeapTuple statisticsTuple = NULL;
+	AttrNumber attributeNumber = InvalidAttrNumber;
+	Oid columnTypeId = InvalidOid;
+	int32 columnTypeMod = 0;
+	Oid columnCollation = InvalidOid;
+	Var *column = NULL;
+	TypeCacheEntry *typeEntry = NULL;
+	List *filenameList = NIL;
+	ListCell *filenameCell = NULL;
+	ListCell *partitionColumnCell = NULL;
+	int64 rowCount = 0;
+	int64 valueCount = 0;
+	bool rowCountKnown = true;
+	bool valueCountKnown = true;
+	Datum minValue = 0;
+	Datum maxValue = 0;
+	bool minMaxFound = false;
+	bool minMaxKnown = true;
+	int64 integerSum = 0;
+	double doubleSum = 0.0;
+	Datum decimalSum = 0;
+	FieldType__Kind sumKind = FIELD_TYPE__KIND__LONG;
+	bool sumFound = false;
+	bool sumKnown = true;
+	AclResult aclResult = ACLCHECK_OK;
+
+	if (get_call_result_type(fcinfo, NULL, &tupleDescriptor) != TYPEFUNC_COMPOSITE)
+	{
+		elog(ERROR, "return type must be a row type");
+	}
+
+	tupleDescriptor = BlessTupleDesc(tupleDescriptor);
+
+	/* statistics show values of the column, so they need the same privilege as reading it */
+	aclResult = pg_class_aclcheck(foreignTableId, GetUserId(), ACL_SELECT);
+
+	attributeNumber = get_attnum(foreignTableId, columnName);
+	if (attributeNumber <= 0)
+	{
+		ereport(ERROR, (errcode(ERRCODE_UNDEFINED_COLUMN),
+				errmsg("column \"%s\" does not exist", columnName)));
+	}
+
+	if (aclResult != ACLCHECK_OK)
+	{
+		aclResult = pg_attribute_aclcheck(foreignTableId, attributeNumber, GetUserId(),
+				ACL_SELECT);
+		if (aclResult != ACLCHECK_OK)
+		{
+			aclcheck_error_col(aclResult, ACL_KIND_CLASS, get_rel_name(foreignTableId),
+					columnName);
+		}
+	}
+
+	options = OrcGetOptions(foreignTableId);
+	foreach(partitionColumnCell, options->partitionColumnNameList)
+	{
+		char *partitionColumnName = (char *) lfirst(partitionColumnCell);
+
+		if (get_attnum(foreignTableId, partitionColumnName) == attributeNumber)
+		{
+			ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					errmsg("column \"%s\" is a partition column", columnName),
+					errdetail("Values of partition columns come from directory names, "
+							"the ORC files have no statistics for them.")));
+		}
+	}
+
+	get_atttypetypmodcoll(foreignTableId, attributeNumber, &columnTypeId, &columnTypeMod,
+			&columnCollation);
+	column = makeVar(1, attributeNumber, columnTypeId, columnTypeMod, columnCollation, 0);
+
+	/*
+	 * Minimums and maximums of the files are compared with the type's sort order,
+	 * which only matches the byte order of strings in the files under C collations.
+	 */
+	typeEntry = lookup_type_cache(columnTypeId, TYPECACHE_CMP_PROC_FINFO);
+	minMaxKnown = OidIsValid(typeEntry->cmp_proc) && StatisticsOrderMatches(column);
+
+	filenameList = OrcFilenameList(options->filename, NIL, NIL, NULL);
+
+	foreach(filenameCell, filenameList)
+	{
+		char *filename = (char *) lfirst(filenameCell);
+		CompressionParameters compressionParameters;
+		PostScript *postScript = NULL;
+		Footer *footer = NULL;
+		FieldType *rootType = NULL;
+		ColumnStatistics *statistics = NULL;
+		FILE *file = NULL;
+		Datum fileMinValue = 0;
+		Datum fileMaxValue = 0;
+
+		file = OrcOpenFile(filename, &postScript, &footer, &compressionParameters);
+
+		/* columns of the table are the fields of the root struct */
+		rootType = footer->types[0];
+		if (attributeNumber > rootType->n_subtypes)
+		{
+			LogError("Column count in table definition does not match with ORC file.");
+		}
+
+		if (rootType->subtypes[attributeNumber - 1] < footer->n_statistics)
+		{
+			statistics = footer->statistics[rootType->subtypes[attributeNumber - 1]];
+		}
+
+		rowCount += (int64) footer->numberofrows;
+		rowCountKnown = rowCountKnown && footer->has_numberofrows;
+
+		if (statistics == NULL || !statistics->has_numberofvalues)
+		{
+			valueCountKnown = false;
+			minMaxKnown = false;
+			sumKnown = false;
+		}
+		else if (statistics->numberofvalues > 0)
+		{
+			valueCount += (int64) statistics->numberofvalues;
+
+			if (minMaxKnown && OrcGetColumnStatistics(column, statistics, &fileMinValue,
+					&fileMaxValue))
+			{
+				if (!minMaxFound || DatumGetInt32(FunctionCall2Coll(&typeEntry->cmp_proc_finfo,
+						columnCollation, fileMinValue, minValue)) < 0)
+				{
+					minValue = fileMinValue;
+				}
+
+				if (!minMaxFound || DatumGetInt32(FunctionCall2Coll(&typeEntry->cmp_proc_finfo,
+						columnCollation, fileMaxValue, maxValue)) > 0)
+				{
+					maxValue = fileMaxValue;
+				}
+
+				minMaxFound = true;
+			}
+			else
+			{
+				minMaxKnown = false;
+			}
+
+			if (statistics->intstatistics != NULL && statistics->intstatistics->has_sum)
+			{
+				int64 fileSum = statistics->intstatistics->sum;
+				bool sumWasPositive = (integerSum >= 0);
+
+				/*
+				 * Overflow is checked as ORC checks it when the sum of a file is
+				 * written, and the sum is unknown if it overflows.
+				 */
+				integerSum = (int64) ((uint64) integerSum + (uint64) fileSum);
+				if ((fileSum >= 0) == sumWasPositive && (integerSum >= 0) != sumWasPositive)
+				{
+					sumKnown = false;
+				}
+
+				sumKind = FIELD_TYPE__KIND__LONG;
+				sumFound = true;
+			}
+			else if (statistics->doublestatistics != NULL &&
+					statistics->doublestatistics->has_sum)
+			{
+				doubleSum += statistics->doublestatistics->sum;
+				sumKind = FIELD_TYPE__KIND__DOUBLE;
+				sumFound = true;
+			}
+			else if (statistics->decimalstatistics != NULL &&
+					statistics->decimalstatistics->sum != NULL)
+			{
+				Datum fileSum = DirectFunctionCall3(numeric_in,
+						CStringGetDatum(statistics->decimalstatistics->sum),
+						ObjectIdGetDatum(InvalidOid), Int32GetDatum(-1));
+
+				decimalSum = sumFound ? DirectFunctionCall2(numeric_add, decimalSum, fileSum) :
+						fileSum;
+				sumKind = FIELD_TYPE__KIND__DECIMAL;
+				sumFound = true;
+			}
+			else
+			{
+				sumKnown = false;
+			}
+		}
+
+		footer__free_unpacked(footer, NULL);
+		post_script__free_unpacked(postScript, NULL);
+		FreeFile(file);
+	}
+
+	memset(values, 0, sizeof(values));
+	memset(nulls, true, sizeof(nulls));
+
+	values[0] = Int64GetDatum(rowCount);
+	nulls[0] = !rowCountKnown;
+
+	values[1] = Int64GetDatum(valueCount);
+	nulls[1] = !valueCountKnown;
+
+	if (minMaxKnown && minMaxFound)
+	{
+		Oid outputFunctionId = InvalidOid;
+		bool typeVarLength = false;
+
+		getTypeOutputInfo(columnTypeId, &outputFunctionId, &typeVarLength);
+
+		values[2] = CStringGetTextDatum(OidOutputFunctionCall(outputFunctionId, minValue));
+		values[3] = CStringGetTextDatum(OidOutputFunctionCall(outputFunctionId, maxValue));
+		nulls[2] = false;
+		nulls[3] = false;
+	}
+
+	if (sumKnown && sumFound)
+	{
+		Datum sumText = 0;
+
+		if (sumKind == FIELD_TYPE__KIND__LONG)
+		{
+			sumText = DirectFunctionCall1(int8out, Int64GetDatum(integerSum));
+		}
+		else if (sumKind == FIELD_TYPE__KIND__DOUBLE)
+		{
+			sumText = DirectFunctionCall1(float8out, Float8GetDatum(doubleSum));
+		}
+		else
+		{
+			sumText = DirectFunctionCall1(numeric_out, decimalSum);
+		}
+
+		values[4] = CStringGetTextDatum(DatumGetCString(sumText));
+		nulls[4] = false;
+	}
+
+	statisticsTuple = heap_form_tuple(tupleDescriptor, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(statisticsTuple));
+}
+
+
 /*
  * OptionNamesString finds all options that are valid for the current context,
  * and concatenates these option names in a comma separated string. The function
@@ -216,13 +539,27 @@ static void
 OrcGetForeignRelSize(PlannerInfo *root, RelOptInfo *baserel, Oid foreignTableId)
 {
 	OrcFdwOptions *options = OrcGetOptions(foreignTableId);
+	List *partitionColumnList = PartitionColumnList(foreignTableId, baserel->relid,
+			options->partitionColumnNameList);
+	List *filenameList = OrcFilenameList(options->filename, partitionColumnList,
+			baserel->baserestrictinfo, NULL);
+	OrcFdwPlanState *planState = OrcPlanFiles(baserel, filenameList);
 
-	double tupleCount = TupleCount(baserel, options->filename);
+	double tupleCount = planState->tupleCount;
 	double rowSelectivity = clauselist_selectivity(root, baserel->baserestrictinfo, 0, JOIN_INNER,
 	NULL);
 
 	double outputRowCount = clamp_row_est(tupleCount * rowSelectivity);
+
+	/* restrictions which contradict each other return no rows, whatever the files */
+	planState->restrictionsRefuted = RestrictionsRefuted(baserel);
+	if (planState->restrictionsRefuted)
+	{
+		outputRowCount = 0;
+	}
+
 	baserel->rows = outputRowCount;
+	baserel->fdw_private = (void *) planState;
 }
 
 
@@ -235,10 +572,10 @@ static void
 OrcGetForeignPaths(PlannerInfo *root, RelOptInfo *baserel, Oid foreignTableId)
 {
 	Path *foreignScanPath = NULL;
-	OrcFdwOptions *options = OrcGetOptions(foreignTableId);
+	OrcFdwPlanState *planState = (OrcFdwPlanState *) baserel->fdw_private;
 
-	BlockNumber pageCount = PageCount(options->filename);
-	double tupleCount = TupleCount(baserel, options->filename);
+	BlockNumber pageCount = planState->pageCount;
+	double tupleCount = planState->tupleCount;
 
 	/*
 	 * We estimate costs almost the same way as cost_seqscan(), thus assuming
@@ -254,6 +591,20 @@ OrcGetForeignPaths(PlannerInfo *root, RelOptInfo *baserel, Oid foreignTableId)
 	double startupCost = baserel->baserestrictcost.startup;
 	double totalCost = startupCost + executionCost;
 
+	/*
+	 * When the restrictions refute themselves, the relation is marked empty the
+	 * way the planner marks relations excluded by constraints: with an Append
+	 * path without subpaths. It is planned as a Result node which returns no
+	 * rows, so no file is opened when the query is executed. The files of the
+	 * table are not used for this, as cached plans must see files which are
+	 * added later; files which can't have rows are skipped by the scan instead.
+	 */
+	if (planState->restrictionsRefuted)
+	{
+		add_path(baserel, (Path *) create_append_path(baserel, NIL, NULL));
+		return;
+	}
+
 	/* create a foreign path node and add it as the only possible path */
 	foreignScanPath = (Path *) create_foreignscan_path(root, baserel, baserel->rows, startupCost,
 			totalCost,
@@ -275,16 +626,29 @@ OrcGetForeignPlan(PlannerInfo *root, RelOptInfo *baserel, Oid foreignTableId, Fo
 		List *targetList, List *scanClauses)
 {
 	ForeignScan *foreignScan = NULL;
+	OrcFdwOptions *options = NULL;
+	List *partitionColumnList = NIL;
 	List *columnList = NULL;
 	List *opExpressionList = NIL;
+	List *filterClauseList = NIL;
+	List *qualClauseList = NIL;
+	List *qualColumnList = NIL;
+	List *subfieldPathList = NIL;
+	List *mapKeyList = NIL;
 	List *foreignPrivateList = NIL;
 
+	options = OrcGetOptions(foreignTableId);
+	partitionColumnList = PartitionColumnList(foreignTableId, baserel->relid,
+			options->partitionColumnNameList);
+
 	/*
-	 * We have no native ability to evaluate restriction clauses, so we just
-	 * put all the scanClauses into the plan node's qual list for the executor
-	 * to check.
+	 * Clauses which can't raise errors are evaluated on batches of rows as they
+	 * are read, so the other columns are read only for the rows which pass them.
+	 * They are taken out of the plan node's qual list, so each clause is evaluated
+	 * once. The other clauses are left to the executor to check.
 	 */
 	scanClauses = extract_actual_clauses(scanClauses, false);
+	filterClauseList = FilterClauseList(scanClauses, partitionColumnList, &qualClauseList);
 
 	/*
 	 * We construct the query document to have MongoDB filter its rows. We could
@@ -302,12 +666,23 @@ OrcGetForeignPlan(PlannerInfo *root, RelOptInfo *baserel, Oid foreignTableId, Fo
 	 */
 	columnList = ColumnList(baserel);
 
-	foreignPrivateList = list_make2(columnList,opExpressionList);
+	/* columns used in the batch filter are read before the others */
+	qualColumnList = QualColumnList(filterClauseList);
+
+	/*
+	 * Struct columns only open the streams of the sub-fields used in the query, and
+	 * map columns only used through their keys only keep the entries of those keys.
+	 */
+	subfieldPathList = SubfieldPathList(root, baserel, &mapKeyList);
+
+	foreignPrivateList = list_make4(columnList, opExpressionList, qualColumnList,
+			subfieldPathList);
+	foreignPrivateList = lappend(foreignPrivateList, mapKeyList);
+	foreignPrivateList = lappend(foreignPrivateList, makeInteger(RowLimit(root, baserel)));
 
-	/* create the foreign scan node */
-	foreignScan = make_foreignscan(targetList, scanClauses, baserel->relid,
-	NIL, /* no expressions to evaluate */
-	foreignPrivateList);
+	/* create the foreign scan node, with the batch filter as its expressions */
+	foreignScan = make_foreignscan(targetList, qualClauseList, baserel->relid,
+			filterClauseList, foreignPrivateList);
 
 	return foreignScan;
 }
@@ -320,19 +695,243 @@ OrcExplainForeignScan(ForeignScanState *scanState, ExplainState *explainState)
 	Oid foreignTableId = RelationGetRelid(scanState->ss.ss_currentRelation);
 	OrcFdwOptions *options = OrcGetOptions(foreignTableId);
 
+	ForeignScan *foreignScan = (ForeignScan *) scanState->ss.ps.plan;
+	List *filenameList = OrcScanFilenameList(foreignTableId, foreignScan, NULL);
+	ListCell *filenameCell = NULL;
+
 	ExplainPropertyText("Orc File", options->filename, explainState);
 
+	/* clauses evaluated on batches are not in the plan's quals, so show them here */
+	if (foreignScan->fdw_exprs != NIL)
+	{
+		Node *filterClause = (Node *) make_ands_explicit(foreignScan->fdw_exprs);
+		List *deparseContext = deparse_context_for_planstate((Node *) scanState, NIL,
+				explainState->rtable, explainState->rtable_names);
+		char *filterString = deparse_expression(filterClause, deparseContext,
+				explainState->verbose, false);
+
+		ExplainPropertyText("Orc Filter", filterString, explainState);
+
+		if (explainState->analyze && scanState->ss.ps.instrument != NULL)
+		{
+			Instrumentation *instrument = scanState->ss.ps.instrument;
+			double filteredRowCount = 0.0;
+
+			if (instrument->nloops > 0)
+			{
+				filteredRowCount = instrument->nfiltered2 / instrument->nloops;
+			}
+
+			ExplainPropertyFloat("Rows Removed by Orc Filter", filteredRowCount, 0,
+					explainState);
+		}
+	}
+
+	/* files of a multi-file table are counted after partition directories are pruned */
+	if (list_length(filenameList) != 1)
+	{
+		ExplainPropertyInteger("Orc File Count", list_length(filenameList), explainState);
+	}
+
 	/* supress file size if we're not showing cost details */
-	if (explainState->costs)
+	if (explainState->costs && filenameList != NIL)
 	{
-		struct stat statBuffer;
+		long totalFileSize = 0;
+		bool fileSizeKnown = false;
+
+		foreach(filenameCell, filenameList)
+		{
+			struct stat statBuffer;
+
+			int statResult = stat((char *) lfirst(filenameCell), &statBuffer);
+			if (statResult == 0)
+			{
+				totalFileSize += (long) statBuffer.st_size;
+				fileSizeKnown = true;
+			}
+		}
+
+		if (fileSizeKnown)
+		{
+			ExplainPropertyLong("Orc File Size", totalFileSize, explainState);
+		}
+	}
+}
+
+
+/*
+ * OrcScanFilenameList resolves the files which the given scan reads when the
+ * scan is begun, so cached plans read the files which are there when they are
+ * executed. Partition directories refuted by the quals of the scan are pruned.
+ * Files are pruned with their statistics as they are opened.
+ */
+static List *
+OrcScanFilenameList(Oid foreignTableId, ForeignScan *foreignScan,
+		List **partitionPathOffsetList)
+{
+	OrcFdwOptions *options = OrcGetOptions(foreignTableId);
+	List *partitionColumnList = PartitionColumnList(foreignTableId, foreignScan->scan.scanrelid,
+			options->partitionColumnNameList);
+
+	List *restrictionList = list_concat(list_copy(foreignScan->scan.plan.qual),
+			list_copy(foreignScan->fdw_exprs));
+
+	return OrcFilenameList(options->filename, partitionColumnList, restrictionList,
+			partitionPathOffsetList);
+}
+
+
+/*
+ * Closes the current file of the scan and opens the next one in the file list.
+ * All files of a table must have the same types, so the record reader and its
+ * buffers are reused for the next file.
+ */
+static void
+OrcOpenNextFile(OrcFdwExecState *execState)
+{
+	char *filename = (char *) lfirst(execState->nextFilenameCell);
+	PostScript *postScript = NULL;
+	Footer *footer = NULL;
+	CompressionParameters compressionParameters;
+	FILE *file = execState->nextFile;
+
+	/* the file is normally opened ahead, while the previous one is read */
+	execState->nextFile = NULL;
+	if (file == NULL)
+	{
+		file = AllocateFile(filename, "r");
+		if (file == NULL)
+		{
+			LogError2("Error opening file %s", filename);
+		}
+	}
+
+	OrcReadFileTail(file, &postScript, &footer, &compressionParameters);
+
+	if (execState->footer != NULL)
+	{
+		if (!OrcFooterTypesMatch(execState->footer, footer))
+		{
+			ereport(ERROR, (errmsg("types of ORC file \"%s\" don't match the other files "
+					"of the table", filename)));
+		}
+
+		footer__free_unpacked(execState->footer, NULL);
+		post_script__free_unpacked(execState->postScript, NULL);
+		FreeFile(execState->file);
+	}
+
+	execState->filename = filename;
+	execState->partitionPathOffset = lfirst_int(execState->nextPartitionPathOffsetCell);
+	execState->nextPartitionPathOffsetCell = lnext(execState->nextPartitionPathOffsetCell);
+	execState->file = file;
+	execState->postScript = postScript;
+	execState->footer = footer;
+	execState->compressionParameters = compressionParameters;
+	execState->nextFilenameCell = lnext(execState->nextFilenameCell);
+	execState->nextStripeNumber = 0;
+
+	/* the footer of the next file is read in the background while this one is read */
+	if (execState->nextFilenameCell != NULL)
+	{
+		execState->nextFile = OrcPrefetchFileTail((char *) lfirst(execState->nextFilenameCell));
+	}
+
+	execState->currentLineNumber = 0;
+	execState->useRowIndex = ENABLE_ROW_SKIPPING && footer->rowindexstride > 0 &&
+			!execState->countOnly && execState->rowLimit == 0;
+
+	if (execState->partitionColumnList != NIL)
+	{
+		OrcSetPartitionValues(execState);
+	}
+
+	/*
+	 * Files which were not there when the query was planned, or which changed
+	 * since, are checked again; none of the stripes of a refuted file are read.
+	 */
+	if (OrcFileRefuted(footer, execState->fileColumnList, execState->queryRestrictionList))
+	{
+		execState->nextStripeNumber = footer->n_stripes;
+	}
+}
+
+
+/*
+ * Opens the given file ahead of reading it, and advises the kernel that its tail,
+ * where its postscript and footer are, will be read soon. The advice doesn't wait
+ * for the read. The file is kept open for when the scan reaches it. Returns NULL
+ * if the file can't be opened; the error is reported when the scan reaches it.
+ */
+static FILE *
+OrcPrefetchFileTail(const char *filename)
+{
+	FILE *file = NULL;
+#ifdef USE_POSIX_FADVISE
+	struct stat statBuffer;
+#endif
+
+	file = AllocateFile(filename, "r");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+#ifdef USE_POSIX_FADVISE
+	if (fstat(fileno(file), &statBuffer) == 0)
+	{
+		off_t prefetchOffset = Max(statBuffer.st_size - ORC_FILE_TAIL_PREFETCH_SIZE, 0);
+
+		(void) posix_fadvise(fileno(file), prefetchOffset, statBuffer.st_size - prefetchOffset,
+				POSIX_FADV_WILLNEED);
+	}
+#endif
+
+	return file;
+}
+
+
+/*
+ * Sets the values of the partition columns for the rows of the current file from
+ * the key=value directory names in its path below the directory of the table.
+ * If a key appears more than once, the directory nearest to the file wins.
+ * Columns whose keys are not in the path are null.
+ */
+static void
+OrcSetPartitionValues(OrcFdwExecState *execState)
+{
+	int partitionColumnCount = list_length(execState->partitionColumnList);
+	MemoryContext oldContext = NULL;
+	char *directoryName = NULL;
+	char *nextSlash = NULL;
+
+	MemoryContextReset(execState->partitionContext);
+	oldContext = MemoryContextSwitchTo(execState->partitionContext);
+
+	memset(execState->partitionValues, 0, partitionColumnCount * sizeof(Datum));
+	memset(execState->partitionNulls, true, partitionColumnCount * sizeof(bool));
+
+	directoryName = pstrdup(execState->filename + execState->partitionPathOffset);
+	while ((nextSlash = strchr(directoryName, '/')) != NULL)
+	{
+		Datum partitionValue = 0;
+		bool partitionIsNull = false;
+		int partitionColumnIndex = 0;
+
+		*nextSlash = '\0';
 
-		int statResult = stat(options->filename, &statBuffer);
-		if (statResult == 0)
+		partitionColumnIndex = OrcParsePartitionDirectory(directoryName,
+				execState->partitionColumnList, &partitionValue, &partitionIsNull);
+		if (partitionColumnIndex >= 0)
 		{
-			ExplainPropertyLong("Orc File Size", (long) statBuffer.st_size, explainState);
+			execState->partitionValues[partitionColumnIndex] = partitionValue;
+			execState->partitionNulls[partitionColumnIndex] = partitionIsNull;
 		}
+
+		directoryName = nextSlash + 1;
 	}
+
+	MemoryContextSwitchTo(oldContext);
 }
 
 
@@ -343,33 +942,48 @@ OrcExplainForeignScan(ForeignScanState *scanState, ExplainState *explainState)
 static void
 OrcGetNextStripe(OrcFdwExecState* execState)
 {
-	Footer* footer = execState->footer;
+	Footer* footer = NULL;
 	int result = 0;
 
 	if (execState->stripeFooter)
 	{
 		stripe_footer__free_unpacked(execState->stripeFooter, NULL);
+		execState->stripeFooter = NULL;
+	}
+
+	/* when the stripes of the current file are read, continue with the next file */
+	while (execState->nextStripeNumber >= execState->footer->n_stripes &&
+			execState->nextFilenameCell != NULL)
+	{
+		OrcOpenNextFile(execState);
 	}
 
+	footer = execState->footer;
+
 	if (execState->nextStripeNumber < footer->n_stripes)
 	{
 		StripeInformation *stripeInfo = footer->stripes[execState->nextStripeNumber];
 		MemoryContext oldContext = CurrentMemoryContext;
 		StripeFooter *stripeFooter = NULL;
 
-		stripeFooter = StripeFooterInit(execState->file, stripeInfo, &execState->compressionParameters);
+		/* rows of the stripe are only counted, there is nothing to read */
+		if (!execState->countOnly)
+		{
+			stripeFooter = StripeFooterInit(execState->file, stripeInfo,
+					&execState->compressionParameters);
 
-		/* switch to orc context for reading data */
-		MemoryContextSwitchTo(execState->orcContext);
+			/* switch to orc context for reading data */
+			MemoryContextSwitchTo(execState->orcContext);
 
-		result = FieldReaderInit(execState->recordReader, execState->file, stripeInfo, stripeFooter,
-				&execState->compressionParameters);
+			result = FieldReaderInit(execState->recordReader, execState->file, stripeInfo,
+					stripeFooter, &execState->compressionParameters, execState->useRowIndex);
 
-		MemoryContextSwitchTo(oldContext);
+			MemoryContextSwitchTo(oldContext);
 
-		if (result)
-		{
-			elog(ERROR, "Cannot read the next stripe information\n");
+			if (result)
+			{
+				elog(ERROR, "Cannot read the next stripe information\n");
+			}
 		}
 
 		execState->stripeFooter = stripeFooter;
@@ -388,8 +1002,29 @@ OrcGetNextStripe(OrcFdwExecState* execState)
 }
 
 
+/*
+ * Sets the modes of the columns for the stride starting at the current line. Constant
+ * values of the columns are kept in the orc context until the stride ends.
+ */
+static void
+OrcSetStrideModes(OrcFdwExecState *execState)
+{
+	StripeInformation *currentStripe = execState->currentStripeInfo;
+	uint32 strideLength = execState->footer->rowindexstride;
+	int strideIndex = execState->currentLineNumber / strideLength;
+	long strideRowCount = Min((long) strideLength,
+			(long) (currentStripe->numberofrows - execState->currentLineNumber));
+	MemoryContext oldContext = MemoryContextSwitchTo(execState->orcContext);
+
+	FieldReaderSetStrideModes(execState->recordReader, strideIndex, strideRowCount);
+
+	MemoryContextSwitchTo(oldContext);
+}
+
+
 static void
-OrcInitializeFieldReader(OrcFdwExecState *execState, List *columns)
+OrcInitializeFieldReader(OrcFdwExecState *execState, List *columns, List *subfieldPathList,
+		List *mapKeyList)
 {
 	FieldReader *recordReader = execState->recordReader;
 	Footer* footer = execState->footer;
@@ -398,7 +1033,8 @@ OrcInitializeFieldReader(OrcFdwExecState *execState, List *columns)
 
 	MemoryContextSwitchTo(execState->orcContext);
 
-	result = FieldReaderAllocate(recordReader, footer, columns);
+	result = FieldReaderAllocate(recordReader, footer, columns, subfieldPathList,
+			mapKeyList);
 
 	MemoryContextSwitchTo(oldContext);
 
@@ -428,10 +1064,16 @@ OrcBeginForeignScan(ForeignScanState *scanState, int executorFlags)
 	Oid foreignTableId = InvalidOid;
 	OrcFdwOptions *options = NULL;
 	List *columnList = NIL;
-	PostScript* postScript = NULL;
-	Footer* footer = NULL;
-	long postScriptOffset = 0;
-	int columnCount = 0;
+	List *qualColumnList = NIL;
+	List *subfieldPathList = NIL;
+	List *mapKeyList = NIL;
+	List *filenameList = NIL;
+	List *partitionPathOffsetList = NIL;
+	List *partitionColumnList = NIL;
+	List *fileColumnList = NIL;
+	ListCell *columnCell = NULL;
+	long rowLimit = 0;
+	int fileColumnCount = 0;
 
 	/* if Explain with no Analyze, do nothing */
 	if (executorFlags & EXEC_FLAG_EXPLAIN_ONLY)
@@ -446,84 +1088,324 @@ OrcBeginForeignScan(ForeignScanState *scanState, int executorFlags)
 	foreignPrivateList = (List *) foreignScan->fdw_private;
 
 	columnList = (List *) linitial(foreignPrivateList);
-
-	execState = (OrcFdwExecState *) palloc(sizeof(OrcFdwExecState));
-	execState->filename = options->filename;
-	execState->currentLineNumber = 0;
-	execState->nextStripeNumber = 0;
-	execState->stripeFooter = NULL;
-	execState->currentStripeInfo = NULL;
-	execState->file = AllocateFile(execState->filename, "r");
-	execState->queryRestrictionList = (List *) lsecond(foreignPrivateList);
-
-	if (execState->file == NULL)
+	if (list_length(foreignPrivateList) > 2)
 	{
-		LogError2("Error opening file %s", execState->filename);
+		qualColumnList = (List *) lthird(foreignPrivateList);
 	}
-
-	postScript = PostScriptInit(execState->file, &postScriptOffset,
-			&execState->compressionParameters);
-
-	if (postScript == NULL)
+	if (list_length(foreignPrivateList) > 3)
 	{
-		elog(ERROR, "Cannot read postscript from the file\n");
+		subfieldPathList = (List *) lfourth(foreignPrivateList);
+	}
+	if (list_length(foreignPrivateList) > 4)
+	{
+		mapKeyList = (List *) list_nth(foreignPrivateList, 4);
+	}
+	if (list_length(foreignPrivateList) > 5)
+	{
+		rowLimit = intVal(list_nth(foreignPrivateList, 5));
 	}
 
-	execState->postScript = postScript;
+	/* files are resolved again, as they may have changed since the query was planned */
+	filenameList = OrcScanFilenameList(foreignTableId, foreignScan, &partitionPathOffsetList);
+
+	/*
+	 * Partition columns are not read from the files, their values are constants.
+	 * The columns before the first of them are the columns of the files.
+	 */
+	partitionColumnList = PartitionColumnList(foreignTableId, foreignScan->scan.scanrelid,
+			options->partitionColumnNameList);
+	fileColumnCount = tupleSlot->tts_tupleDescriptor->natts;
+	foreach(columnCell, partitionColumnList)
+	{
+		TargetEntry *partitionColumn = (TargetEntry *) lfirst(columnCell);
 
-	footer = FileFooterInit(execState->file, postScriptOffset - postScript->footerlength,
-			postScript->footerlength, &execState->compressionParameters);
+		fileColumnCount = Min(fileColumnCount, partitionColumn->resno - 1);
+	}
 
-	if (footer == NULL)
+	foreach(columnCell, columnList)
 	{
-		elog(ERROR, "Cannot read file footer from the file\n");
+		Var *column = (Var *) lfirst(columnCell);
+
+		if (column->varattno <= fileColumnCount)
+		{
+			fileColumnList = lappend(fileColumnList, column);
+		}
+	}
+
+	execState = (OrcFdwExecState *) palloc0(sizeof(OrcFdwExecState));
+	execState->filenameList = filenameList;
+	execState->nextFilenameCell = list_head(filenameList);
+	execState->nextPartitionPathOffsetCell = list_head(partitionPathOffsetList);
+	execState->currentLineNumber = 0;
+	execState->nextStripeNumber = 0;
+	execState->stripeFooter = NULL;
+	execState->currentStripeInfo = NULL;
+	execState->queryRestrictionList = (List *) lsecond(foreignPrivateList);
+	execState->partitionColumnList = partitionColumnList;
+	execState->fileColumnCount = fileColumnCount;
+	execState->countOnly = (fileColumnList == NIL);
+	execState->rowLimit = rowLimit;
+	execState->batchedRowCount = 0;
+
+	/*
+	 * The batch filter is evaluated in its own expression context, which is reset
+	 * for each row. The per-tuple context of the scan holds the memory of the row
+	 * being handed out while batches are filled.
+	 */
+	if (foreignScan->fdw_exprs != NIL)
+	{
+		execState->filterList = (List *) ExecInitExpr((Expr *) foreignScan->fdw_exprs,
+				(PlanState *) scanState);
+		execState->filterContext = CreateExprContext(scanState->ss.ps.state);
+	}
+
+	execState->fileColumnList = fileColumnList;
+	execState->qualColumnList = qualColumnList;
+	execState->subfieldPathList = subfieldPathList;
+	execState->mapKeyList = mapKeyList;
+	execState->scanContext = CurrentMemoryContext;
+
+	scanState->fdw_state = (void *) execState;
+
+	/* a table without files has no rows, there is nothing to read */
+	if (execState->nextFilenameCell == NULL)
+	{
+		return;
 	}
 
+	/*
+	 * The first file is opened here, but its footer is read when the first row is
+	 * read. Until then, the kernel reads the tail of the file in the background. Under an Append, all scans are
+	 * begun before any row is read, so the footers of their files are read at the
+	 * same time rather than one after another.
+	 */
+	execState->nextFile = OrcPrefetchFileTail((char *) lfirst(execState->nextFilenameCell));
+}
+
+
+/*
+ * Opens the first file of the scan and initializes the record reader and the
+ * batch for it. Called when the first row is read, in the per-tuple context, so
+ * the state of the scan is allocated in the context the scan was begun in.
+ */
+static void
+OrcInitializeScan(ForeignScanState *scanState)
+{
+	OrcFdwExecState *execState = (OrcFdwExecState *) scanState->fdw_state;
+	int partitionColumnCount = list_length(execState->partitionColumnList);
+	int fileColumnCount = execState->fileColumnCount;
+	int columnCount = 0;
+	MemoryContext oldContext = MemoryContextSwitchTo(execState->scanContext);
+
+	if (execState->partitionColumnList != NIL)
+	{
+		execState->partitionContext = AllocSetContextCreate(CurrentMemoryContext,
+				"orc_fdw partition context",
+				ALLOCSET_SMALL_MINSIZE,
+				ALLOCSET_SMALL_INITSIZE,
+				ALLOCSET_SMALL_MAXSIZE);
+		execState->partitionValues = palloc0(partitionColumnCount * sizeof(Datum));
+		execState->partitionNulls = palloc0(partitionColumnCount * sizeof(bool));
+	}
+
+	OrcOpenNextFile(execState);
+
 	execState->orcContext = AllocSetContextCreate(CurrentMemoryContext, "orc_fdw data context",
 			ALLOCSET_DEFAULT_MINSIZE,
 			ALLOCSET_DEFAULT_INITSIZE,
-			Max(ALLOCSET_DEFAULT_MAXSIZE, postScript->compressionblocksize * 2));
+			Max(ALLOCSET_DEFAULT_MAXSIZE, execState->postScript->compressionblocksize * 2));
 
-	execState->footer = footer;
 	execState->recordReader = palloc(sizeof(FieldReader));
 
-	OrcInitializeFieldReader(execState, columnList);
+	OrcInitializeFieldReader(execState, execState->fileColumnList, execState->subfieldPathList,
+			execState->mapKeyList);
 
 	columnCount = ((StructFieldReader *) execState->recordReader->fieldReader)->noOfFields;
-	if (columnCount != tupleSlot->tts_tupleDescriptor->natts)
+	if (columnCount != fileColumnCount)
 	{
 		LogError("Column count in table definition does not match with ORC file.");
 	}
 
-	scanState->fdw_state = (void *) execState;
+	execState->strideChecks = OrcCompileStrideChecks(execState->recordReader,
+			execState->queryRestrictionList, &execState->strideCheckCount,
+			&execState->otherRestrictionList);
+
+	OrcInitializeLateMaterialization(execState, scanState, execState->qualColumnList);
+	OrcInitializeBatch(execState);
+
+	MemoryContextSwitchTo(oldContext);
+}
+
+
+/*
+ * Decides whether the columns used in the batch filter are read before the other
+ * columns. This is worth doing only if some required columns are not used by it.
+ */
+static void
+OrcInitializeLateMaterialization(OrcFdwExecState *execState, ForeignScanState *scanState,
+		List *qualColumnList)
+{
+	StructFieldReader *structFieldReader =
+			(StructFieldReader *) execState->recordReader->fieldReader;
+	int columnCount = structFieldReader->noOfFields;
+	int columnNo = 0;
+	bool hasOtherColumn = false;
+
+	execState->lateMaterialization = false;
+	execState->qualColumnMask = NULL;
+	execState->otherColumnMask = NULL;
+
+	if (qualColumnList == NIL || execState->filterList == NIL)
+	{
+		return;
+	}
+
+	execState->qualColumnMask = palloc0(columnCount * sizeof(bool));
+	execState->otherColumnMask = palloc0(columnCount * sizeof(bool));
+
+	for (columnNo = 0; columnNo < columnCount; ++columnNo)
+	{
+		FieldReader *fieldReader = structFieldReader->fields[columnNo];
+
+		if (!fieldReader->required)
+		{
+			continue;
+		}
+
+		if (list_member_int(qualColumnList, columnNo + 1))
+		{
+			execState->qualColumnMask[columnNo] = true;
+		}
+		else
+		{
+			execState->otherColumnMask[columnNo] = true;
+			hasOtherColumn = true;
+		}
+	}
+
+	execState->lateMaterialization = hasOtherColumn;
+}
+
+
+/*
+ * Allocates the column vectors of the required columns and the selection vector
+ * if there is a batch filter. Vectors of the other columns are left NULL.
+ */
+static void
+OrcInitializeBatch(OrcFdwExecState *execState)
+{
+	StructFieldReader *structFieldReader =
+			(StructFieldReader *) execState->recordReader->fieldReader;
+	int columnCount = structFieldReader->noOfFields;
+	int columnNo = 0;
+
+	execState->batchContext = AllocSetContextCreate(CurrentMemoryContext,
+			"orc_fdw batch context",
+			ALLOCSET_DEFAULT_MINSIZE,
+			ALLOCSET_DEFAULT_INITSIZE,
+			ALLOCSET_DEFAULT_MAXSIZE);
+
+	execState->batchValues = palloc0(columnCount * sizeof(Datum *));
+	execState->batchNulls = palloc0(columnCount * sizeof(bool *));
+	execState->batchSelection = NULL;
+	execState->batchRowCount = 0;
+	execState->batchRowIndex = 0;
+
+	for (columnNo = 0; columnNo < columnCount; ++columnNo)
+	{
+		if (!structFieldReader->fields[columnNo]->required)
+		{
+			continue;
+		}
+
+		execState->batchValues[columnNo] = palloc(ORC_BATCH_SIZE * sizeof(Datum));
+		execState->batchNulls[columnNo] = palloc(ORC_BATCH_SIZE * sizeof(bool));
+	}
+
+	if (execState->filterList != NIL)
+	{
+		execState->batchSelection = palloc(ORC_BATCH_SIZE * sizeof(bool));
+	}
 }
 
 
 /*
- * OrcIterateForeignScan reads the next record from the data file, converts it
- * to PostgreSQL tuple, and stores the converted tuple into the ScanTupleSlot as
- * a virtual tuple.
+ * OrcIterateForeignScan hands out the next row of the current batch, filling a
+ * new batch when the current one is consumed. The row is stored into the
+ * ScanTupleSlot as a virtual tuple.
  */
 static TupleTableSlot *
 OrcIterateForeignScan(ForeignScanState *scanState)
 {
 	OrcFdwExecState *execState = (OrcFdwExecState *) scanState->fdw_state;
 	TupleTableSlot *tupleSlot = scanState->ss.ss_ScanTupleSlot;
-	StripeInformation *currentStripe = execState->currentStripeInfo;
-	Footer *footer = execState->footer;
-
-	TupleDesc tupleDescriptor = tupleSlot->tts_tupleDescriptor;
 	Datum *columnValues = tupleSlot->tts_values;
 	bool *columnNulls = tupleSlot->tts_isnull;
-	int columnCount = tupleDescriptor->natts;
-	bool nextStripeNeeded = false;
-
-	/* initialize all values for this row to null */
-	memset(columnValues, 0, columnCount * sizeof(Datum));
-	memset(columnNulls, true, columnCount * sizeof(bool));
+	int columnCount = tupleSlot->tts_tupleDescriptor->natts;
+	int fileColumnCount = execState->fileColumnCount;
+	int columnNo = 0;
+	uint32 rowIndex = 0;
 
 	ExecClearTuple(tupleSlot);
 
+	if (execState->recordReader == NULL)
+	{
+		/* a table without files has no rows */
+		if (execState->nextFilenameCell == NULL)
+		{
+			return tupleSlot;
+		}
+
+		OrcInitializeScan(scanState);
+	}
+
+	/* find the next row which is not filtered out by the batch filter */
+	do
+	{
+		while (execState->batchRowIndex >= execState->batchRowCount)
+		{
+			if (!OrcFillBatch(scanState))
+			{
+				return tupleSlot;
+			}
+		}
+
+		rowIndex = execState->batchRowIndex++;
+	} while (execState->batchSelection != NULL && !execState->batchSelection[rowIndex]);
+
+	for (columnNo = 0; columnNo < fileColumnCount; ++columnNo)
+	{
+		if (execState->batchValues[columnNo] == NULL)
+		{
+			columnValues[columnNo] = (Datum) 0;
+			columnNulls[columnNo] = true;
+			continue;
+		}
+
+		columnValues[columnNo] = execState->batchValues[columnNo][rowIndex];
+		columnNulls[columnNo] = execState->batchNulls[columnNo][rowIndex];
+	}
+
+	OrcFillPartitionColumns(execState, columnValues, columnNulls, columnCount);
+
+	ExecStoreVirtualTuple(tupleSlot);
+
+	return tupleSlot;
+}
+
+
+/*
+ * Moves the readers to the next rows to be read. Stripes are read as they end
+ * and, at the start of each stride, strides refuted by the quals are skipped.
+ * Returns false if there are no rows left in the file.
+ */
+static bool
+OrcMoveToNextRows(OrcFdwExecState *execState)
+{
+	StripeInformation *currentStripe = execState->currentStripeInfo;
+	Footer *footer = execState->footer;
+	bool nextStripeNeeded = false;
+
 	/*
 	 * This is loop to implement the row skipping functionality. When we try to read a row,
 	 * if we are reading the first element of a stride, we check the min/max values of the
@@ -544,23 +1426,24 @@ OrcIterateForeignScan(ForeignScanState *scanState)
 		if (currentStripe == NULL)
 		{
 			/* file is empty */
-			return tupleSlot;
+			return false;
 		}
 		else if (execState->currentLineNumber >= currentStripe->numberofrows)
 		{
 			/* End of stripe, read next one */
 			OrcGetNextStripe(execState);
 			currentStripe = execState->currentStripeInfo;
+			footer = execState->footer;
 
 			if (execState->nextStripeNumber > execState->footer->n_stripes)
 			{
 				/* finish reading if there are no more stipes left */
-				return tupleSlot;
+				return false;
 			}
 		}
 
 		/* check if indices are defined in the file */
-		if (ENABLE_ROW_SKIPPING && footer->rowindexstride > 0 &&
+		if (execState->useRowIndex &&
 				execState->currentLineNumber % footer->rowindexstride == 0)
 		{
 			List *strideRestrictionList = NIL;
@@ -582,10 +1465,17 @@ OrcIterateForeignScan(ForeignScanState *scanState)
 			/* while the current stride is not needed and there are stride remaining, iterate the strides */
 			do
 			{
-				strideRestrictionList = OrcCreateStrideRestrictions(execState->recordReader,
-						currentStrideIndex);
-				strideSkipped = predicate_refuted_by(strideRestrictionList,
-						execState->queryRestrictionList);
+				strideSkipped = OrcStrideChecksRefute(execState->recordReader,
+						currentStrideIndex, execState->strideChecks,
+						execState->strideCheckCount);
+
+				if (!strideSkipped && execState->otherRestrictionList != NIL)
+				{
+					strideRestrictionList = OrcCreateStrideRestrictions(
+							execState->recordReader, currentStrideIndex);
+					strideSkipped = predicate_refuted_by(strideRestrictionList,
+							execState->otherRestrictionList);
+				}
 
 				if (strideSkipped)
 				{
@@ -612,114 +1502,783 @@ OrcIterateForeignScan(ForeignScanState *scanState)
 		}
 	} while (nextStripeNeeded);
 
-	FillTupleSlot(execState->recordReader, columnValues, columnNulls);
-	execState->currentLineNumber++;
-
-	ExecStoreVirtualTuple(tupleSlot);
-
-	return tupleSlot;
-}
-
-
-/* OrcReScanForeignScan rescans the foreign table. */
-static void
-OrcReScanForeignScan(ForeignScanState *scanState)
-{
-	OrcEndForeignScan(scanState);
-	OrcBeginForeignScan(scanState, 0);
+	return true;
 }
 
 
 /*
- * OrcEndForeignScan finishes scanning the foreign table, and frees the acquired
- * resources.
+ * Reads the next batch of rows into the column vectors, one column at a time.
+ * A batch ends at the end of the current stride or stripe. Returns false if
+ * there are no rows left in the file.
  */
-static void
-OrcEndForeignScan(ForeignScanState *scanState)
+static bool
+OrcFillBatch(ForeignScanState *scanState)
 {
-	OrcFdwExecState *executionState = (OrcFdwExecState *) scanState->fdw_state;
+	OrcFdwExecState *execState = (OrcFdwExecState *) scanState->fdw_state;
+	uint32 strideLength = 0;
+	bool strideStart = false;
+	uint32 rowCount = 0;
+	MemoryContext oldContext = NULL;
 
-	if (executionState == NULL)
+	if (!OrcMoveToNextRows(execState))
 	{
-		return;
+		return false;
 	}
 
-	/* clears all file related memory memory */
-	FieldReaderFree(executionState->recordReader);
+	/* rows may be in the next file now */
+	strideLength = execState->footer->rowindexstride;
 
-	MemoryContextDelete(executionState->orcContext);
+	/* without columns to read, the rest of the stripe is handed out as one batch */
+	if (execState->countOnly)
+	{
+		rowCount = execState->currentStripeInfo->numberofrows - execState->currentLineNumber;
 
-	if (executionState->stripeFooter)
+		execState->currentLineNumber += rowCount;
+		execState->batchRowCount = rowCount;
+		execState->batchRowIndex = 0;
+
+		return true;
+	}
+
+	rowCount = Min(ORC_BATCH_SIZE,
+			execState->currentStripeInfo->numberofrows - execState->currentLineNumber);
+
+	if (execState->useRowIndex)
 	{
-		stripe_footer__free_unpacked(executionState->stripeFooter, NULL);
-		executionState->stripeFooter = NULL;
+		uint32 strideRowsLeft = strideLength - execState->currentLineNumber % strideLength;
+
+		rowCount = Min(rowCount, strideRowsLeft);
+		strideStart = (strideRowsLeft == strideLength);
 	}
 
-	if (executionState->postScript)
+	/* with a LIMIT, only the rows which are still needed are decoded */
+	if (execState->rowLimit > execState->batchedRowCount)
 	{
-		post_script__free_unpacked(executionState->postScript, NULL);
-		executionState->postScript = NULL;
+		rowCount = Min(rowCount, (uint32) (execState->rowLimit - execState->batchedRowCount));
 	}
 
-	if (executionState->file)
+	/* at the start of a stride, use its statistics to choose how each column is read */
+	if (strideStart)
 	{
-		FreeFile(executionState->file);
+		OrcSetStrideModes(execState);
 	}
-}
 
+	/* values of the previous batch are all handed out */
+	MemoryContextReset(execState->batchContext);
 
-/*
- * OrcGetOptions returns the option values to be used when reading and parsing
- * the orc file.
- */
-static OrcFdwOptions *
-OrcGetOptions(Oid foreignTableId)
-{
-	OrcFdwOptions *orcFdwOptions = NULL;
-	char *filename = NULL;
+	if (!execState->lateMaterialization)
+	{
+		oldContext = MemoryContextSwitchTo(execState->batchContext);
+		FillColumnBatch(execState, NULL, NULL, rowCount);
+		MemoryContextSwitchTo(oldContext);
 
-	filename = OrcGetOptionValue(foreignTableId, OPTION_NAME_FILENAME);
+		if (execState->filterList != NIL)
+		{
+			OrcSelectBatchRows(scanState, rowCount);
+		}
+	}
+	else
+	{
+		/* first read only the columns used in the filter and check the rows with them */
+		oldContext = MemoryContextSwitchTo(execState->batchContext);
+		FillColumnBatch(execState, execState->qualColumnMask, NULL, rowCount);
+		MemoryContextSwitchTo(oldContext);
 
-	orcFdwOptions = (OrcFdwOptions *) palloc0(sizeof(OrcFdwOptions));
-	orcFdwOptions->filename = filename;
+		OrcSelectBatchRows(scanState, rowCount);
 
-	return orcFdwOptions;
+		/* read the rest of the columns only for the rows which pass */
+		oldContext = MemoryContextSwitchTo(execState->batchContext);
+		FillColumnBatch(execState, execState->otherColumnMask, execState->batchSelection,
+				rowCount);
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	execState->currentLineNumber += rowCount;
+	execState->batchedRowCount += rowCount;
+	execState->batchRowCount = rowCount;
+	execState->batchRowIndex = 0;
+
+	return true;
 }
 
 
 /*
- * OrcGetOptionValue walks over foreign table and foreign server options, and
- * looks for the option with the given name. If found, the function returns the
- * option's value. This function is unchanged from mongo_fdw.
+ * Evaluates the batch filter for each row of the batch using the values of the
+ * columns used in it, and marks the rows which pass in the selection vector.
  */
-static char *
-OrcGetOptionValue(Oid foreignTableId, const char *optionName)
+static void
+OrcSelectBatchRows(ForeignScanState *scanState, uint32 rowCount)
 {
-	ForeignTable *foreignTable = NULL;
-	ForeignServer *foreignServer = NULL;
-	List *optionList = NIL;
-	ListCell *optionCell = NULL;
-	char *optionValue = NULL;
+	OrcFdwExecState *execState = (OrcFdwExecState *) scanState->fdw_state;
+	TupleTableSlot *tupleSlot = scanState->ss.ss_ScanTupleSlot;
+	Datum *columnValues = tupleSlot->tts_values;
+	bool *columnNulls = tupleSlot->tts_isnull;
+	int columnCount = tupleSlot->tts_tupleDescriptor->natts;
+	ExprContext *filterContext = execState->filterContext;
+	int structFieldCount =
+			((StructFieldReader *) execState->recordReader->fieldReader)->noOfFields;
+	uint32 rowIndex = 0;
+	int columnNo = 0;
 
-	foreignTable = GetForeignTable(foreignTableId);
-	foreignServer = GetForeignServer(foreignTable->serverid);
+	/* other columns are null while the quals are checked */
+	memset(columnValues, 0, columnCount * sizeof(Datum));
+	memset(columnNulls, true, columnCount * sizeof(bool));
 
-	optionList = list_concat(optionList, foreignTable->options);
-	optionList = list_concat(optionList, foreignServer->options);
+	OrcFillPartitionColumns(execState, columnValues, columnNulls, columnCount);
 
-	foreach(optionCell, optionList)
+	for (rowIndex = 0; rowIndex < rowCount; ++rowIndex)
 	{
-		DefElem *optionDef = (DefElem *) lfirst(optionCell);
-		char *optionDefName = optionDef->defname;
+		ExecClearTuple(tupleSlot);
 
-		if (strncmp(optionDefName, optionName, NAMEDATALEN) == 0)
+		for (columnNo = 0; columnNo < structFieldCount; ++columnNo)
 		{
-			optionValue = defGetString(optionDef);
-			break;
+			if (!execState->qualColumnMask[columnNo])
+			{
+				continue;
+			}
+
+			columnValues[columnNo] = execState->batchValues[columnNo][rowIndex];
+			columnNulls[columnNo] = execState->batchNulls[columnNo][rowIndex];
 		}
-	}
 
-	return optionValue;
+		ExecStoreVirtualTuple(tupleSlot);
+		filterContext->ecxt_scantuple = tupleSlot;
+
+		execState->batchSelection[rowIndex] =
+				ExecQual(execState->filterList, filterContext, false);
+
+		if (!execState->batchSelection[rowIndex])
+		{
+			InstrCountFiltered2(scanState, 1);
+		}
+
+		ResetExprContext(filterContext);
+	}
+
+	ExecClearTuple(tupleSlot);
+}
+
+
+/*
+ * Copies the values of the partition columns for the current file into the
+ * given column arrays. Dropped columns after the columns of the file are null.
+ */
+static void
+OrcFillPartitionColumns(OrcFdwExecState *execState, Datum *columnValues, bool *columnNulls,
+		int columnCount)
+{
+	int fileColumnCount = execState->fileColumnCount;
+	int partitionColumnIndex = 0;
+	ListCell *partitionColumnCell = NULL;
+
+	memset(columnValues + fileColumnCount, 0, (columnCount - fileColumnCount) * sizeof(Datum));
+	memset(columnNulls + fileColumnCount, true, (columnCount - fileColumnCount) * sizeof(bool));
+
+	foreach(partitionColumnCell, execState->partitionColumnList)
+	{
+		TargetEntry *partitionColumn = (TargetEntry *) lfirst(partitionColumnCell);
+		int columnNo = partitionColumn->resno - 1;
+
+		columnValues[columnNo] = execState->partitionValues[partitionColumnIndex];
+		columnNulls[columnNo] = execState->partitionNulls[partitionColumnIndex];
+		partitionColumnIndex++;
+	}
+}
+
+
+/* OrcReScanForeignScan rescans the foreign table. */
+static void
+OrcReScanForeignScan(ForeignScanState *scanState)
+{
+	OrcEndForeignScan(scanState);
+	OrcBeginForeignScan(scanState, 0);
+}
+
+
+/*
+ * OrcEndForeignScan finishes scanning the foreign table, and frees the acquired
+ * resources.
+ */
+static void
+OrcEndForeignScan(ForeignScanState *scanState)
+{
+	OrcFdwExecState *executionState = (OrcFdwExecState *) scanState->fdw_state;
+
+	if (executionState == NULL)
+	{
+		return;
+	}
+
+	if (executionState->filterContext)
+	{
+		FreeExprContext(executionState->filterContext, true);
+		executionState->filterContext = NULL;
+	}
+
+	/* the next file may be open even if no row was read */
+	if (executionState->nextFile)
+	{
+		FreeFile(executionState->nextFile);
+		executionState->nextFile = NULL;
+	}
+
+	/* a table without files has no reader */
+	if (executionState->recordReader == NULL)
+	{
+		return;
+	}
+
+	/* clears all file related memory memory */
+	FieldReaderFree(executionState->recordReader);
+
+	MemoryContextDelete(executionState->orcContext);
+	MemoryContextDelete(executionState->batchContext);
+
+	if (executionState->partitionContext)
+	{
+		MemoryContextDelete(executionState->partitionContext);
+	}
+
+	if (executionState->stripeFooter)
+	{
+		stripe_footer__free_unpacked(executionState->stripeFooter, NULL);
+		executionState->stripeFooter = NULL;
+	}
+
+	if (executionState->footer)
+	{
+		footer__free_unpacked(executionState->footer, NULL);
+		executionState->footer = NULL;
+	}
+
+	if (executionState->postScript)
+	{
+		post_script__free_unpacked(executionState->postScript, NULL);
+		executionState->postScript = NULL;
+	}
+
+	if (executionState->file)
+	{
+		FreeFile(executionState->file);
+	}
+}
+
+
+/*
+ * OrcGetOptions returns the option values to be used when reading and parsing
+ * the orc file.
+ */
+static OrcFdwOptions *
+OrcGetOptions(Oid foreignTableId)
+{
+	OrcFdwOptions *orcFdwOptions = NULL;
+	char *filename = NULL;
+	char *partitionColumns = NULL;
+	List *partitionColumnNameList = NIL;
+
+	filename = OrcGetOptionValue(foreignTableId, OPTION_NAME_FILENAME);
+	partitionColumns = OrcGetOptionValue(foreignTableId, OPTION_NAME_PARTITION_COLUMNS);
+
+	/* column names are parsed as identifiers, like in column lists of commands */
+	if (partitionColumns != NULL &&
+			!SplitIdentifierString(pstrdup(partitionColumns), ',', &partitionColumnNameList))
+	{
+		ereport(ERROR, (errcode(ERRCODE_FDW_INVALID_STRING_FORMAT),
+				errmsg("invalid list syntax for \"%s\"", OPTION_NAME_PARTITION_COLUMNS)));
+	}
+
+	orcFdwOptions = (OrcFdwOptions *) palloc0(sizeof(OrcFdwOptions));
+	orcFdwOptions->filename = filename;
+	orcFdwOptions->partitionColumnNameList = partitionColumnNameList;
+
+	return orcFdwOptions;
+}
+
+
+/*
+ * OrcGetOptionValue walks over foreign table and foreign server options, and
+ * looks for the option with the given name. If found, the function returns the
+ * option's value. This function is unchanged from mongo_fdw.
+ */
+static char *
+OrcGetOptionValue(Oid foreignTableId, const char *optionName)
+{
+	ForeignTable *foreignTable = NULL;
+	ForeignServer *foreignServer = NULL;
+	List *optionList = NIL;
+	ListCell *optionCell = NULL;
+	char *optionValue = NULL;
+
+	foreignTable = GetForeignTable(foreignTableId);
+	foreignServer = GetForeignServer(foreignTable->serverid);
+
+	optionList = list_concat(optionList, foreignTable->options);
+	optionList = list_concat(optionList, foreignServer->options);
+
+	foreach(optionCell, optionList)
+	{
+		DefElem *optionDef = (DefElem *) lfirst(optionCell);
+		char *optionDefName = optionDef->defname;
+
+		if (strncmp(optionDefName, optionName, NAMEDATALEN) == 0)
+		{
+			optionValue = defGetString(optionDef);
+			break;
+		}
+	}
+
+	return optionValue;
+}
+
+
+/*
+ * OrcFilenameList resolves the filename option into the list of files to read.
+ * The option is a comma separated list of entries, where each entry is a file,
+ * a directory whose files are read, or a glob pattern. Other entries are kept
+ * as they are, so a missing file is reported when it is read, as for single
+ * file tables. When partition columns and restrictions are given, partition
+ * directories refuted by the restrictions are pruned while they are walked.
+ *
+ * If partitionPathOffsetList is given, the offset in each file's path where the
+ * directories below the entry start is stored into it. Only those directories
+ * are partition directories, so key=value names in the path of the table's own
+ * directory are not taken as partition values.
+ */
+static List *
+OrcFilenameList(const char *filename, List *partitionColumnList, List *restrictionList,
+		List **partitionPathOffsetList)
+{
+	List *filenameList = NIL;
+	char *entryList = pstrdup(filename);
+	char *entry = entryList;
+
+	while (entry != NULL)
+	{
+		char *nextEntry = strchr(entry, ',');
+		char *entryEnd = NULL;
+		struct stat statBuffer;
+		StringInfo pattern = NULL;
+		bool directory = false;
+		List *matchingFilenameList = NIL;
+
+		if (nextEntry != NULL)
+		{
+			*nextEntry = '\0';
+			nextEntry++;
+		}
+
+		/* trim the spaces around the entry */
+		while (isspace((unsigned char) *entry))
+		{
+			entry++;
+		}
+
+		entryEnd = entry + strlen(entry);
+		while (entryEnd > entry && isspace((unsigned char) entryEnd[-1]))
+		{
+			entryEnd--;
+		}
+		*entryEnd = '\0';
+
+		if (*entry == '\0')
+		{
+			entry = nextEntry;
+			continue;
+		}
+
+		pattern = makeStringInfo();
+		directory = (stat(entry, &statBuffer) == 0 && S_ISDIR(statBuffer.st_mode));
+
+		if (directory)
+		{
+			appendStringInfo(pattern, "%s/*", entry);
+		}
+		else
+		{
+			appendStringInfoString(pattern, entry);
+		}
+
+		if (directory || strpbrk(entry, "*?[") != NULL)
+		{
+			matchingFilenameList = OrcMatchingFilenameList(pattern->data, directory,
+					partitionColumnList, NIL, restrictionList);
+		}
+		else
+		{
+			matchingFilenameList = list_make1(pstrdup(entry));
+		}
+
+		if (partitionPathOffsetList != NULL)
+		{
+			int partitionPathOffset = OrcPartitionPathOffset(pattern->data);
+			int matchingFileCount = list_length(matchingFilenameList);
+			int matchingFileIndex = 0;
+
+			for (matchingFileIndex = 0; matchingFileIndex < matchingFileCount;
+					matchingFileIndex++)
+			{
+				*partitionPathOffsetList = lappend_int(*partitionPathOffsetList,
+						partitionPathOffset);
+			}
+		}
+
+		filenameList = list_concat(filenameList, matchingFilenameList);
+		entry = nextEntry;
+	}
+
+	return filenameList;
+}
+
+
+/*
+ * OrcPartitionPathOffset returns the offset in the paths the given pattern matches
+ * where the directories matched by the pattern start. This is the offset after
+ * the last slash before the first wildcard, or before the file name if the
+ * pattern has no wildcards.
+ */
+static int
+OrcPartitionPathOffset(const char *pattern)
+{
+	const char *wildcard = strpbrk(pattern, "*?[");
+	int offset = (wildcard != NULL) ? (int) (wildcard - pattern) : (int) strlen(pattern);
+
+	while (offset > 0 && pattern[offset - 1] != '/')
+	{
+		offset--;
+	}
+
+	return offset;
+}
+
+
+/*
+ * OrcMatchingFilenameList returns the files which the given glob pattern matches
+ * in name order. Matched directories named key=value are partition directories,
+ * as in Hive, and their files are read too. If the key is a partition column,
+ * the directory is pruned when the restrictions of the query refute the column's
+ * value in it and in the partition directories above it, so the directories of
+ * pruned partitions are never listed. If the pattern lists a directory, hidden
+ * files and files starting with an underscore, like _SUCCESS markers, are left
+ * out.
+ */
+static List *
+OrcMatchingFilenameList(const char *pattern, bool directory, List *partitionColumnList,
+		List *partitionRestrictionList, List *restrictionList)
+{
+	List *filenameList = NIL;
+	glob_t globResult;
+	size_t pathIndex = 0;
+	int globResultCode = 0;
+
+	/* directories are marked with a trailing slash, so they aren't stat'ed here */
+	globResultCode = glob(pattern, GLOB_MARK, NULL, &globResult);
+	if (globResultCode == GLOB_NOMATCH)
+	{
+		return NIL;
+	}
+	else if (globResultCode != 0)
+	{
+		ereport(ERROR, (errmsg("could not resolve ORC files of \"%s\"", pattern)));
+	}
+
+	for (pathIndex = 0; pathIndex < globResult.gl_pathc; pathIndex++)
+	{
+		char *path = pstrdup(globResult.gl_pathv[pathIndex]);
+		int pathLength = strlen(path);
+		bool subdirectory = (pathLength > 1 && path[pathLength - 1] == '/');
+		List *directoryRestrictionList = partitionRestrictionList;
+		StringInfo directoryPattern = NULL;
+		char *baseName = NULL;
+		int partitionColumnIndex = -1;
+		Datum partitionValue = 0;
+		bool partitionIsNull = false;
+
+		if (subdirectory)
+		{
+			path[pathLength - 1] = '\0';
+		}
+
+		baseName = strrchr(path, '/');
+		baseName = (baseName != NULL) ? baseName + 1 : path;
+		if (directory && (baseName[0] == '.' || baseName[0] == '_'))
+		{
+			continue;
+		}
+
+		if (!subdirectory)
+		{
+			filenameList = lappend(filenameList, path);
+			continue;
+		}
+
+		if (strchr(baseName, '=') == NULL)
+		{
+			continue;
+		}
+
+		partitionColumnIndex = OrcParsePartitionDirectory(baseName, partitionColumnList,
+				&partitionValue, &partitionIsNull);
+
+		if (partitionColumnIndex >= 0 && restrictionList != NIL)
+		{
+			TargetEntry *partitionColumn = (TargetEntry *) list_nth(partitionColumnList,
+					partitionColumnIndex);
+			Node *partitionRestriction = OrcCreatePartitionRestriction(
+					(Var *) partitionColumn->expr, partitionValue, partitionIsNull);
+
+			if (partitionRestriction != NULL)
+			{
+				directoryRestrictionList = lappend(list_copy(partitionRestrictionList),
+						partitionRestriction);
+
+				if (predicate_refuted_by(directoryRestrictionList, restrictionList))
+				{
+					continue;
+				}
+			}
+		}
+
+		directoryPattern = makeStringInfo();
+		appendStringInfo(directoryPattern, "%s/*", path);
+
+		filenameList = list_concat(filenameList, OrcMatchingFilenameList(
+				directoryPattern->data, true, partitionColumnList, directoryRestrictionList,
+				restrictionList));
+	}
+
+	globfree(&globResult);
+
+	return filenameList;
+}
+
+
+/*
+ * OrcParsePartitionDirectory parses a partition directory name of the form
+ * key=value. If the key is the name of one of the given partition columns, the
+ * function converts the value to the column's type and returns the index of the
+ * column in the list. Otherwise, it returns -1. Values are unescaped the way
+ * Hive escapes them, and the value of Hive's default partition is null.
+ */
+static int
+OrcParsePartitionDirectory(const char *directoryName, List *partitionColumnList,
+		Datum *value, bool *isNull)
+{
+	const char *separator = strchr(directoryName, '=');
+	char *key = NULL;
+	StringInfo valueString = NULL;
+	const char *valueChar = NULL;
+	ListCell *partitionColumnCell = NULL;
+	int partitionColumnIndex = 0;
+
+	*value = (Datum) 0;
+	*isNull = true;
+
+	if (separator == NULL)
+	{
+		return -1;
+	}
+
+	key = pnstrdup(directoryName, separator - directoryName);
+
+	foreach(partitionColumnCell, partitionColumnList)
+	{
+		TargetEntry *partitionColumn = (TargetEntry *) lfirst(partitionColumnCell);
+		Var *column = (Var *) partitionColumn->expr;
+		Oid inputFunctionId = InvalidOid;
+		Oid typeIOParam = InvalidOid;
+
+		if (pg_strcasecmp(key, partitionColumn->resname) != 0)
+		{
+			partitionColumnIndex++;
+			continue;
+		}
+
+		valueString = makeStringInfo();
+		for (valueChar = separator + 1; *valueChar != '\0'; valueChar++)
+		{
+			if (valueChar[0] == '%' && isxdigit((unsigned char) valueChar[1]) &&
+					isxdigit((unsigned char) valueChar[2]))
+			{
+				char hexDigits[3] = { valueChar[1], valueChar[2], '\0' };
+
+				appendStringInfoChar(valueString, (char) strtol(hexDigits, NULL, 16));
+				valueChar += 2;
+			}
+			else
+			{
+				appendStringInfoChar(valueString, *valueChar);
+			}
+		}
+
+		if (strcmp(valueString->data, HIVE_DEFAULT_PARTITION_NAME) != 0)
+		{
+			getTypeInputInfo(column->vartype, &inputFunctionId, &typeIOParam);
+
+			*value = OidInputFunctionCall(inputFunctionId, valueString->data, typeIOParam,
+					column->vartypmod);
+			*isNull = false;
+		}
+
+		return partitionColumnIndex;
+	}
+
+	return -1;
+}
+
+
+/*
+ * PartitionColumnList returns the partition columns of the table as target
+ * entries, which keep the names of the columns with their Vars. Partition columns
+ * must be the last columns of the table, not counting dropped columns, since the
+ * other columns are matched to the fields of the files by their positions.
+ */
+static List *
+PartitionColumnList(Oid foreignTableId, Index tableId, List *partitionColumnNameList)
+{
+	List *partitionColumnList = NIL;
+	List *partitionColumnNumberList = NIL;
+	Relation relation = NULL;
+	TupleDesc tupleDescriptor = NULL;
+	ListCell *columnNameCell = NULL;
+	ListCell *columnNumberCell = NULL;
+
+	if (partitionColumnNameList == NIL)
+	{
+		return NIL;
+	}
+
+	foreach(columnNameCell, partitionColumnNameList)
+	{
+		char *columnName = (char *) lfirst(columnNameCell);
+		AttrNumber attributeNumber = get_attnum(foreignTableId, columnName);
+
+		if (attributeNumber <= 0)
+		{
+			ereport(ERROR, (errcode(ERRCODE_UNDEFINED_COLUMN),
+					errmsg("partition column \"%s\" does not exist", columnName)));
+		}
+
+		partitionColumnNumberList = lappend_int(partitionColumnNumberList, attributeNumber);
+	}
+
+	relation = heap_open(foreignTableId, AccessShareLock);
+	tupleDescriptor = RelationGetDescr(relation);
+
+	forboth(columnNameCell, partitionColumnNameList, columnNumberCell, partitionColumnNumberList)
+	{
+		char *columnName = (char *) lfirst(columnNameCell);
+		AttrNumber attributeNumber = (AttrNumber) lfirst_int(columnNumberCell);
+		AttrNumber laterAttributeNumber = 0;
+		Oid columnTypeId = InvalidOid;
+		int32 columnTypeMod = 0;
+		Oid columnCollation = InvalidOid;
+		Var *column = NULL;
+
+		/* only dropped columns and other partition columns may come after it */
+		for (laterAttributeNumber = attributeNumber + 1;
+				laterAttributeNumber <= tupleDescriptor->natts; laterAttributeNumber++)
+		{
+			Form_pg_attribute attribute = tupleDescriptor->attrs[laterAttributeNumber - 1];
+
+			if (!attribute->attisdropped &&
+					!list_member_int(partitionColumnNumberList, laterAttributeNumber))
+			{
+				ereport(ERROR, (errmsg("partition column \"%s\" is not one of the last "
+						"columns of the foreign table", columnName),
+						errhint("Columns of the ORC files must come before partition columns.")));
+			}
+		}
+
+		get_atttypetypmodcoll(foreignTableId, attributeNumber, &columnTypeId, &columnTypeMod,
+				&columnCollation);
+		column = makeVar(tableId, attributeNumber, columnTypeId, columnTypeMod,
+				columnCollation, 0);
+
+		partitionColumnList = lappend(partitionColumnList,
+				makeTargetEntry((Expr *) column, attributeNumber, columnName, false));
+	}
+
+	heap_close(relation, AccessShareLock);
+
+	return partitionColumnList;
+}
+
+
+/*
+ * OrcOpenFile opens the given ORC file, and reads its postscript and footer.
+ * Errors out if they cannot be read.
+ */
+static FILE *
+OrcOpenFile(const char *filename, PostScript **postScript, Footer **footer,
+		CompressionParameters *compressionParameters)
+{
+	FILE *file = NULL;
+
+	file = AllocateFile(filename, "r");
+	if (file == NULL)
+	{
+		LogError2("Error opening file %s", filename);
+	}
+
+	OrcReadFileTail(file, postScript, footer, compressionParameters);
+
+	return file;
+}
+
+
+/*
+ * OrcReadFileTail reads the postscript and footer of the given open ORC file.
+ * Errors out if they cannot be read.
+ */
+static void
+OrcReadFileTail(FILE *file, PostScript **postScript, Footer **footer,
+		CompressionParameters *compressionParameters)
+{
+	long postScriptOffset = 0;
+
+	*postScript = PostScriptInit(file, &postScriptOffset, compressionParameters);
+	if (*postScript == NULL)
+	{
+		elog(ERROR, "Cannot read postscript from the file\n");
+	}
+
+	*footer = FileFooterInit(file, postScriptOffset - (*postScript)->footerlength,
+			(*postScript)->footerlength, compressionParameters);
+	if (*footer == NULL)
+	{
+		elog(ERROR, "Cannot read file footer from the file\n");
+	}
+}
+
+
+/*
+ * OrcFooterTypesMatch returns true if the files of the given footers have the
+ * same types, so they can be read with the same record reader.
+ */
+static bool
+OrcFooterTypesMatch(Footer *footer, Footer *otherFooter)
+{
+	int typeIndex = 0;
+
+	if (footer->n_types != otherFooter->n_types)
+	{
+		return false;
+	}
+
+	for (typeIndex = 0; typeIndex < footer->n_types; typeIndex++)
+	{
+		FieldType *type = footer->types[typeIndex];
+		FieldType *otherType = otherFooter->types[typeIndex];
+
+		if (type->kind != otherType->kind || type->n_subtypes != otherType->n_subtypes ||
+				memcmp(type->subtypes, otherType->subtypes,
+						type->n_subtypes * sizeof(uint32_t)) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 
@@ -752,42 +2311,121 @@ TupleCount(RelOptInfo *baserel, const char *filename)
 		struct stat statBuffer;
 		int tupleWidth = 0;
 
-		int statResult = stat(filename, &statBuffer);
-		if (statResult < 0)
+		int statResult = stat(filename, &statBuffer);
+		if (statResult < 0)
+		{
+			/* file may not be there at plan time, so use a default estimate */
+			statBuffer.st_size = 10 * BLCKSZ;
+		}
+
+		tupleWidth = MAXALIGN(baserel->width) + MAXALIGN(sizeof(HeapTupleHeaderData));
+		tupleCount = clamp_row_est((double) statBuffer.st_size / (double) tupleWidth);
+	}
+
+	return tupleCount;
+}
+
+
+/* PageCount calculates and returns the number of pages in a file. */
+static BlockNumber
+PageCount(const char *filename)
+{
+	BlockNumber pageCount = 0;
+	struct stat statBuffer;
+
+	/* if file doesn't exist at plan time, use default estimate for its size */
+	int statResult = stat(filename, &statBuffer);
+	if (statResult < 0)
+	{
+		statBuffer.st_size = 10 * BLCKSZ;
+	}
+
+	pageCount = (statBuffer.st_size + (BLCKSZ - 1)) / BLCKSZ;
+	if (pageCount < 1)
+	{
+		pageCount = 1;
+	}
+
+	return pageCount;
+}
+
+
+/*
+ * OrcPlanFiles sums up the row and page count estimates of the files of the
+ * table. Footers are not read while planning, so planning doesn't get slower
+ * with the number of files; files are pruned with their statistics when the
+ * scan opens them. Files which are not there at plan time are estimated with
+ * a default size.
+ */
+static OrcFdwPlanState *
+OrcPlanFiles(RelOptInfo *baserel, List *filenameList)
+{
+	OrcFdwPlanState *planState = (OrcFdwPlanState *) palloc0(sizeof(OrcFdwPlanState));
+	ListCell *filenameCell = NULL;
+
+	foreach(filenameCell, filenameList)
+	{
+		char *filename = (char *) lfirst(filenameCell);
+
+		planState->tupleCount += TupleCount(baserel, filename);
+		planState->pageCount += PageCount(filename);
+	}
+
+	planState->tupleCount = clamp_row_est(planState->tupleCount);
+
+	return planState;
+}
+
+
+/*
+ * RestrictionsRefuted returns true if the restrictions of the query contradict
+ * each other, like "dt = '2026-10-01' AND dt = '2026-10-02'" on a partition
+ * column, so no row can pass them. Restrictions with mutable functions are left
+ * out, as the planner does for constraint exclusion.
+ */
+static bool
+RestrictionsRefuted(RelOptInfo *baserel)
+{
+	List *restrictionList = NIL;
+	ListCell *restrictInfoCell = NULL;
+
+	foreach(restrictInfoCell, baserel->baserestrictinfo)
+	{
+		RestrictInfo *restrictInfo = (RestrictInfo *) lfirst(restrictInfoCell);
+
+		if (!contain_mutable_functions((Node *) restrictInfo->clause))
 		{
-			/* file may not be there at plan time, so use a default estimate */
-			statBuffer.st_size = 10 * BLCKSZ;
+			restrictionList = lappend(restrictionList, restrictInfo->clause);
 		}
-
-		tupleWidth = MAXALIGN(baserel->width) + MAXALIGN(sizeof(HeapTupleHeaderData));
-		tupleCount = clamp_row_est((double) statBuffer.st_size / (double) tupleWidth);
 	}
 
-	return tupleCount;
+	return predicate_refuted_by(restrictionList, restrictionList);
 }
 
 
-/* PageCount calculates and returns the number of pages in a file. */
-static BlockNumber
-PageCount(const char *filename)
+/*
+ * OrcFileRefuted returns true if the file of the given footer has no rows for
+ * the query: either the file is empty, or the min/max values in its statistics
+ * refute the restrictions of the query.
+ */
+static bool
+OrcFileRefuted(Footer *footer, List *columnList, List *restrictionList)
 {
-	BlockNumber pageCount = 0;
-	struct stat statBuffer;
+	List *fileRestrictionList = NIL;
 
-	/* if file doesn't exist at plan time, use default estimate for its size */
-	int statResult = stat(filename, &statBuffer);
-	if (statResult < 0)
+	if (footer->has_numberofrows && footer->numberofrows == 0)
 	{
-		statBuffer.st_size = 10 * BLCKSZ;
+		return true;
 	}
 
-	pageCount = (statBuffer.st_size + (BLCKSZ - 1)) / BLCKSZ;
-	if (pageCount < 1)
+	if (restrictionList == NIL)
 	{
-		pageCount = 1;
+		return false;
 	}
 
-	return pageCount;
+	fileRestrictionList = OrcCreateFileRestrictions(footer, columnList);
+
+	return predicate_refuted_by(fileRestrictionList, restrictionList);
 }
 
 
@@ -853,35 +2491,455 @@ ColumnList(RelOptInfo *baserel)
 
 
 /*
- * Fills the column slots in the tuple by reading from the file
+ * Returns the no of rows the query needs from the scan if it has a LIMIT, or 0.
+ * The limit applies to the scan only if the table is the only relation in the
+ * query, and its rows are neither filtered, sorted, grouped nor aggregated.
  */
-static void
-FillTupleSlot(FieldReader *recordReader, Datum *columnValues, bool *columnNulls)
+static long
+RowLimit(PlannerInfo *root, RelOptInfo *baserel)
 {
-	FieldReader* fieldReader = NULL;
-	StructFieldReader* structFieldReader = NULL;
-	int columnNo = 0;
+	Query *query = root->parse;
 
-	structFieldReader = (StructFieldReader*) recordReader->fieldReader;
+	if (root->limit_tuples <= 0 || baserel->baserestrictinfo != NIL ||
+			bms_membership(root->all_baserels) != BMS_SINGLETON)
+	{
+		return 0;
+	}
 
-	for (columnNo = 0; columnNo < structFieldReader->noOfFields; ++columnNo)
+	if (query->sortClause != NIL || query->groupClause != NIL ||
+			query->distinctClause != NIL || query->havingQual != NULL ||
+			query->hasAggs || query->hasWindowFuncs)
 	{
-		fieldReader = structFieldReader->fields[columnNo];
-		if (!fieldReader->required)
+		return 0;
+	}
+
+	return (long) root->limit_tuples;
+}
+
+
+/*
+ * FilterClauseList returns the scan clauses which are evaluated on batches of
+ * rows as they are read, and stores the other clauses into otherClauseList. Such
+ * clauses may be evaluated for rows the executor never asks for, so they must not
+ * raise errors or have side effects. They must also use a column of the files,
+ * since batches are not read when only partition columns are needed.
+ */
+static List *
+FilterClauseList(List *scanClauses, List *partitionColumnList, List **otherClauseList)
+{
+	List *filterClauseList = NIL;
+	ListCell *scanClauseCell = NULL;
+
+	*otherClauseList = NIL;
+
+	foreach(scanClauseCell, scanClauses)
+	{
+		Node *scanClause = (Node *) lfirst(scanClauseCell);
+		List *clauseColumnList = NIL;
+		ListCell *clauseColumnCell = NULL;
+		bool usesFileColumn = false;
+
+		if (contain_volatile_functions(scanClause) ||
+				FilterClauseWalker(scanClause, NULL))
 		{
+			*otherClauseList = lappend(*otherClauseList, scanClause);
 			continue;
 		}
 
-		if (fieldReader->kind == FIELD_TYPE__KIND__LIST)
+		clauseColumnList = pull_var_clause(scanClause, PVC_RECURSE_AGGREGATES,
+				PVC_RECURSE_PLACEHOLDERS);
+
+		foreach(clauseColumnCell, clauseColumnList)
+		{
+			Var *column = (Var *) lfirst(clauseColumnCell);
+			ListCell *partitionColumnCell = NULL;
+			bool partitionColumn = false;
+
+			foreach(partitionColumnCell, partitionColumnList)
+			{
+				TargetEntry *partitionEntry = (TargetEntry *) lfirst(partitionColumnCell);
+
+				if (partitionEntry->resno == column->varattno)
+				{
+					partitionColumn = true;
+					break;
+				}
+			}
+
+			if (!partitionColumn)
+			{
+				usesFileColumn = true;
+				break;
+			}
+		}
+
+		if (usesFileColumn)
 		{
-			columnValues[columnNo] = ReadListFieldAsDatum(fieldReader, columnNulls + columnNo);
+			filterClauseList = lappend(filterClauseList, scanClause);
 		}
 		else
 		{
-			columnValues[columnNo] = ReadPrimitiveFieldAsDatum(fieldReader, columnNulls + columnNo);
+			*otherClauseList = lappend(*otherClauseList, scanClause);
+		}
+	}
+
+	return filterClauseList;
+}
+
+
+/*
+ * FilterClauseWalker returns true if the given expression can't be evaluated on
+ * batches of rows. Only columns of the row, constants and parameters of the query
+ * combined with leakproof functions are allowed; leakproof functions don't raise
+ * errors for any of their inputs. Whole row and system column references are not
+ * allowed, as batches only have the user columns.
+ */
+static bool
+FilterClauseWalker(Node *node, void *context)
+{
+	if (node == NULL)
+	{
+		return false;
+	}
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+		{
+			Var *column = (Var *) node;
+			return (column->varattno <= 0 || column->varlevelsup > 0);
+		}
+
+		case T_Const:
+		{
+			return false;
+		}
+
+		case T_Param:
+		{
+			Param *parameter = (Param *) node;
+			return (parameter->paramkind != PARAM_EXTERN);
+		}
+
+		case T_OpExpr:
+		case T_DistinctExpr:
+		case T_NullIfExpr:
+		{
+			OpExpr *opExpression = (OpExpr *) node;
+
+			set_opfuncid(opExpression);
+			if (!get_func_leakproof(opExpression->opfuncid))
+			{
+				return true;
+			}
+			break;
+		}
+
+		case T_ScalarArrayOpExpr:
+		{
+			ScalarArrayOpExpr *arrayOpExpression = (ScalarArrayOpExpr *) node;
+
+			set_sa_opfuncid(arrayOpExpression);
+			if (!get_func_leakproof(arrayOpExpression->opfuncid))
+			{
+				return true;
+			}
+			break;
+		}
+
+		case T_FuncExpr:
+		{
+			FuncExpr *functionExpression = (FuncExpr *) node;
+
+			if (!get_func_leakproof(functionExpression->funcid))
+			{
+				return true;
+			}
+			break;
+		}
+
+		case T_BoolExpr:
+		case T_NullTest:
+		case T_BooleanTest:
+		case T_RelabelType:
+		case T_List:
+		{
+			break;
+		}
+
+		default:
+		{
+			return true;
+		}
+	}
+
+	return expression_tree_walker(node, FilterClauseWalker, context);
+}
+
+
+/*
+ * QualColumnList returns the attribute numbers of the columns used in the given
+ * scan clauses. If the clauses cannot be evaluated before the rest of the row is
+ * read, like when they refer to the whole row or contain volatile functions which
+ * must not be evaluated twice, an empty list is returned.
+ */
+static List *
+QualColumnList(List *scanClauses)
+{
+	List *qualColumnList = NIL;
+	List *clauseColumnList = NIL;
+	ListCell *clauseColumnCell = NULL;
+
+	if (scanClauses == NIL || contain_volatile_functions((Node *) scanClauses))
+	{
+		return NIL;
+	}
+
+	clauseColumnList = pull_var_clause((Node *) scanClauses, PVC_RECURSE_AGGREGATES,
+			PVC_RECURSE_PLACEHOLDERS);
+
+	foreach(clauseColumnCell, clauseColumnList)
+	{
+		Var *column = (Var *) lfirst(clauseColumnCell);
+
+		if (column->varattno <= 0)
+		{
+			/* whole row and system column references need the complete row */
+			return NIL;
+		}
+
+		if (!list_member_int(qualColumnList, column->varattno))
+		{
+			qualColumnList = lappend_int(qualColumnList, column->varattno);
+		}
+	}
+
+	return qualColumnList;
+}
+
+
+/*
+ * SubfieldPathList walks the query and returns the paths of the sub-fields of the
+ * foreign table's columns used in it. Each path is an integer list starting with
+ * the column's attribute number, followed by the field numbers selected from it.
+ * A column used as a whole has a path with only its attribute number. We need to
+ * walk the query because the planner only gives us the whole column references.
+ * If the whole row is referenced, an empty list is returned and all the sub-fields
+ * are read.
+ *
+ * Keys looked up in json typed columns with the -> and ->> operators are stored in
+ * mapKeyList as pairs of the attribute number and the key. Such lookups are not
+ * added to the sub-field paths, so map columns not used otherwise can leave out the
+ * other keys.
+ */
+static List *
+SubfieldPathList(PlannerInfo *root, RelOptInfo *baserel, List **mapKeyList)
+{
+	SubfieldPathContext context;
+
+	context.relationId = baserel->relid;
+	context.sublevelsUp = 0;
+	context.wholeRow = false;
+	context.subfieldPathList = NIL;
+	context.mapKeyList = NIL;
+
+	query_tree_walker(root->parse, SubfieldPathWalker, (void *) &context, 0);
+
+	if (context.wholeRow)
+	{
+		*mapKeyList = NIL;
+		return NIL;
+	}
+
+	*mapKeyList = context.mapKeyList;
+	return context.subfieldPathList;
+}
+
+
+/*
+ * SubfieldPathWalker adds the column references of the foreign table in the given
+ * node to the sub-field path list. Field selections are followed down to the column
+ * they are applied to.
+ */
+static bool
+SubfieldPathWalker(Node *node, SubfieldPathContext *context)
+{
+	if (node == NULL)
+	{
+		return false;
+	}
+
+	if (IsA(node, FieldSelect))
+	{
+		Node *argument = node;
+		List *path = NIL;
+
+		/* the innermost field selection is the first one applied to the column */
+		while (IsA(argument, FieldSelect))
+		{
+			FieldSelect *fieldSelect = (FieldSelect *) argument;
+
+			path = lcons_int(fieldSelect->fieldnum, path);
+			argument = (Node *) fieldSelect->arg;
+		}
+
+		if (IsA(argument, Var))
+		{
+			Var *column = (Var *) argument;
+
+			if (column->varno == context->relationId &&
+					column->varlevelsup == context->sublevelsUp && column->varattno > 0)
+			{
+				AddSubfieldPath(context, lcons_int(column->varattno, path));
+				return false;
+			}
+		}
+
+		return SubfieldPathWalker(argument, context);
+	}
+	else if (IsA(node, Var))
+	{
+		Var *column = (Var *) node;
+
+		if (column->varno == context->relationId &&
+				column->varlevelsup == context->sublevelsUp)
+		{
+			if (column->varattno > 0)
+			{
+				AddSubfieldPath(context, list_make1_int(column->varattno));
+			}
+			else
+			{
+				context->wholeRow = true;
+			}
+		}
+
+		return false;
+	}
+	else if (IsA(node, OpExpr))
+	{
+		OpExpr *opExpression = (OpExpr *) node;
+
+		/* operators read from stored rules don't have their function ids set */
+		set_opfuncid(opExpression);
+
+		if (AddMapKey(context, opExpression->opfuncid, opExpression->args))
+		{
+			return false;
 		}
 	}
+	else if (IsA(node, FuncExpr))
+	{
+		FuncExpr *functionExpression = (FuncExpr *) node;
+
+		if (AddMapKey(context, functionExpression->funcid, functionExpression->args))
+		{
+			return false;
+		}
+	}
+	else if (IsA(node, Query))
+	{
+		bool result = false;
+
+		context->sublevelsUp++;
+		result = query_tree_walker((Query *) node, SubfieldPathWalker, (void *) context, 0);
+		context->sublevelsUp--;
+
+		return result;
+	}
+
+	return expression_tree_walker(node, SubfieldPathWalker, (void *) context);
+}
+
+
+/*
+ * AddSubfieldPath adds the path to the list in the context if it is not there yet.
+ */
+static void
+AddSubfieldPath(SubfieldPathContext *context, List *path)
+{
+	if (!list_member(context->subfieldPathList, path))
+	{
+		context->subfieldPathList = lappend(context->subfieldPathList, path);
+	}
+}
+
+
+/*
+ * AddMapKey adds the key to the map key list in the context if the function looks
+ * up a constant key in one of the foreign table's columns.
+ *
+ * @return true if the key is added, false if the function is not a key lookup
+ */
+static bool
+AddMapKey(SubfieldPathContext *context, Oid functionId, List *argumentList)
+{
+	Var *column = NULL;
+	Const *key = NULL;
+	List *mapKey = NIL;
+
+	if (functionId != F_JSON_OBJECT_FIELD && functionId != F_JSON_OBJECT_FIELD_TEXT)
+	{
+		return false;
+	}
+
+	if (list_length(argumentList) != 2 || !IsA(linitial(argumentList), Var) ||
+			!IsA(lsecond(argumentList), Const))
+	{
+		return false;
+	}
+
+	column = (Var *) linitial(argumentList);
+	key = (Const *) lsecond(argumentList);
+
+	if (column->varno != context->relationId || column->varlevelsup != context->sublevelsUp ||
+			column->varattno <= 0 || key->constisnull)
+	{
+		return false;
+	}
+
+	mapKey = list_make2(makeInteger(column->varattno),
+			makeString(TextDatumGetCString(key->constvalue)));
+
+	if (!list_member(context->mapKeyList, mapKey))
+	{
+		context->mapKeyList = lappend(context->mapKeyList, mapKey);
+	}
+
+	return true;
+}
+
+/*
+ * Reads the values of the next rows of the required columns into their column
+ * vectors, one column at a time. If a column mask is given, only the columns set
+ * in the mask are read. If a selection vector is given, only the selected rows
+ * are converted and the others are skipped.
+ */
+static void
+FillColumnBatch(OrcFdwExecState *execState, bool *columnMask, bool *selection,
+		uint32 rowCount)
+{
+	StructFieldReader *structFieldReader =
+			(StructFieldReader *) execState->recordReader->fieldReader;
+	int columnNo = 0;
+
+	for (columnNo = 0; columnNo < structFieldReader->noOfFields; ++columnNo)
+	{
+		FieldReader *fieldReader = structFieldReader->fields[columnNo];
+		int result = 0;
+
+		if (!fieldReader->required || (columnMask && !columnMask[columnNo]))
+		{
+			continue;
+		}
 
+		result = ReadFieldValues(fieldReader, execState->batchValues[columnNo],
+				execState->batchNulls[columnNo], selection, (int) rowCount);
+		if (result)
+		{
+			LogError("Error occurred while reading column");
+		}
+	}
 }
 
 
@@ -895,21 +2953,31 @@ OrcAnalyzeForeignTable(Relation relation, AcquireSampleRowsFunc *acquireSampleRo
 {
 	Oid foreignTableId = RelationGetRelid(relation);
 	OrcFdwOptions *options = OrcGetOptions(foreignTableId);
+	List *filenameList = OrcFilenameList(options->filename, NIL, NIL, NULL);
 	BlockNumber pageCount = 0;
-	struct stat statBuffer;
+	off_t totalFileSize = 0;
+	ListCell *filenameCell = NULL;
 
-	int statResult = stat(options->filename, &statBuffer);
-	if (statResult < 0)
+	foreach(filenameCell, filenameList)
 	{
-		ereport(ERROR,
-				(errcode_for_file_access(), errmsg("could not stat file \"%s\": %m", options->filename)));
+		char *filename = (char *) lfirst(filenameCell);
+		struct stat statBuffer;
+
+		int statResult = stat(filename, &statBuffer);
+		if (statResult < 0)
+		{
+			ereport(ERROR,
+					(errcode_for_file_access(), errmsg("could not stat file \"%s\": %m", filename)));
+		}
+
+		totalFileSize += statBuffer.st_size;
 	}
 
 	/*
 	 * Our estimate should return at least 1 so that we can tell later on that
 	 * pg_class.relpages is not default.
 	 */
-	pageCount = (statBuffer.st_size + (BLCKSZ - 1)) / BLCKSZ;
+	pageCount = (totalFileSize + (BLCKSZ - 1)) / BLCKSZ;
 	if (pageCount < 1)
 	{
 		pageCount = 1;
@@ -976,7 +3044,8 @@ OrcAcquireSampleRows(Relation relation, int logLevel, HeapTuple *sampleRows,
 
 	/* setup foreign scan plan node */
 	// TODO is giving an empty expression list ok?
-	foreignPrivateList = list_make2(columnList,opExpressionList);
+	foreignPrivateList = list_make4(columnList, opExpressionList, NIL, NIL);
+	foreignPrivateList = lappend(foreignPrivateList, NIL);
 	foreignScan = makeNode(ForeignScan);
 	foreignScan->fdw_private = foreignPrivateList;
 
@@ -998,7 +3067,7 @@ OrcAcquireSampleRows(Relation relation, int logLevel, HeapTuple *sampleRows,
 
 	/*
 	 * Use per-tuple memory context to prevent leak of memory used to read and
-	 * parse rows from the file using ReadLineFromFile and FillTupleSlot.
+	 * parse rows from the file using ReadLineFromFile and FillColumnBatch.
 	 */
 	tupleContext = AllocSetContextCreate(CurrentMemoryContext, "orc_fdw temporary context",
 	ALLOCSET_DEFAULT_MINSIZE,
@@ -27,11 +27,21 @@
 /* when enabled, index data will also be read from the file and unnecessary rows will be skipped */
 #define ENABLE_ROW_SKIPPING 1
 
+/* no of rows read column by column into the column vectors at once */
+#define ORC_BATCH_SIZE 1024
+
+/* no of bytes at the end of a file read ahead of its postscript and footer */
+#define ORC_FILE_TAIL_PREFETCH_SIZE (16 * 1024)
+
 /* Defines for valid option names and default values */
 #define OPTION_NAME_FILENAME "filename"
+#define OPTION_NAME_PARTITION_COLUMNS "partition_columns"
 
 #define ORC_TUPLE_COST_MULTIPLIER 10
 
+/* directory name value of Hive's partition for null partition column values */
+#define HIVE_DEFAULT_PARTITION_NAME "__HIVE_DEFAULT_PARTITION__"
+
 
 /*
  * OrcValidOption keeps an option name and a context. When an option is passed
@@ -47,11 +57,12 @@ typedef struct OrcValidOption
 
 
 /* Array of options that are valid for orc_fdw */
-static const uint32 ValidOptionCount = 3;
+static const uint32 ValidOptionCount = 2;
 static const OrcValidOption ValidOptionArray[] =
 {
 	/* foreign table options */
 	{ OPTION_NAME_FILENAME, ForeignTableRelationId },
+	{ OPTION_NAME_PARTITION_COLUMNS, ForeignTableRelationId },
 };
 
 
@@ -59,21 +70,52 @@ static const OrcValidOption ValidOptionArray[] =
  * OrcFdwOptions holds the option values to be used when reading and parsing
  * the orc file. To resolve these values, we first check foreign table's
  * options, and if not present, we then fall back to the default values 
- * specified above.
+ * specified above. The filename option may be a comma separated list of files,
+ * directories and glob patterns. The partition_columns option names the columns
+ * whose values come from the key=value directories the files are in, as in Hive.
  */
 typedef struct OrcFdwOptions
 {
 	char *filename;
+	List *partitionColumnNameList;
 
 } OrcFdwOptions;
 
 
+/*
+ * OrcFdwPlanState keeps estimates of the total row count and page count of the
+ * files of the foreign table at plan time, after partition directories refuted
+ * by the restrictions are pruned, and whether the restrictions refute each other.
+ * It is passed between the planning callbacks in baserel. The files are only
+ * used for estimates; the scan resolves them again when it is begun.
+ */
+typedef struct OrcFdwPlanState
+{
+	double tupleCount;
+	BlockNumber pageCount;
+	bool restrictionsRefuted;
+
+} OrcFdwPlanState;
+
+
 /*
  * OrcFdwExecState keeps foreign data wrapper specific execution state that we
  * create and hold onto when executing the query.
  */
 typedef struct OrcFdwExecState
 {
+	/*
+	 * Files are read one after another with the same record reader. The next file
+	 * is opened while the current one is read, so its tail is read ahead.
+	 */
+	List *filenameList;
+	ListCell *nextFilenameCell;
+	FILE *nextFile;
+
+	/* partition values are parsed from the path of each file after this offset */
+	ListCell *nextPartitionPathOffsetCell;
+	int partitionPathOffset;
+
 	char *filename;
 	FILE *file;
 	PostScript *postScript;
@@ -84,15 +126,98 @@ typedef struct OrcFdwExecState
 	MemoryContext orcContext;
 	List *queryRestrictionList;
 
+	/*
+	 * Restrictions are compiled into checks against the min/max statistics of
+	 * strides once per scan. The other restrictions are checked with the theorem
+	 * prover against the restrictions built from the statistics.
+	 */
+	struct StrideCheck *strideChecks;
+	int strideCheckCount;
+	List *otherRestrictionList;
+
+	/* columns and sub-fields to read, kept from the plan until the first file is opened */
+	List *fileColumnList;
+	List *qualColumnList;
+	List *subfieldPathList;
+	List *mapKeyList;
+	MemoryContext scanContext;
+
+	/*
+	 * Partition columns are the last columns of the table, after the columns of
+	 * the files. Their values are the same for all rows of a file, and are parsed
+	 * from the directory names in its path when the file is opened.
+	 */
+	List *partitionColumnList;
+	int fileColumnCount;
+	MemoryContext partitionContext;
+	Datum *partitionValues;
+	bool *partitionNulls;
+
+	/*
+	 * Clauses which can't raise errors are evaluated on each batch as it is read,
+	 * in their own expression context. Columns used in them are read first for the
+	 * batch. Other columns are read only for the rows which pass them.
+	 */
+	List *filterList;
+	struct ExprContext *filterContext;
+	bool lateMaterialization;
+	bool *qualColumnMask;
+	bool *otherColumnMask;
+
+	/*
+	 * When no column is required, as in count(*), only the row counts of the
+	 * stripes in the file footer are used. Stripe footers and streams are not read.
+	 */
+	bool countOnly;
+
+	/*
+	 * No of rows a LIMIT needs from the scan, 0 if not known. Batches are sized to
+	 * the rows still needed. Row indexes are used for skipping strides and choosing
+	 * stride modes; they are not read when only the first rows are needed.
+	 */
+	long rowLimit;
+	long batchedRowCount;
+	bool useRowIndex;
+
+	/*
+	 * Rows are read in batches one column at a time into the column vectors, and
+	 * then handed out one by one. Batches don't span strides, so stride modes and
+	 * row skipping apply to whole batches. With a batch filter, the selection vector
+	 * marks the rows of the batch which pass it. Values of a batch live in the batch
+	 * context.
+	 */
+	MemoryContext batchContext;
+	Datum **batchValues;
+	bool **batchNulls;
+	bool *batchSelection;
+	uint32 batchRowCount;
+	uint32 batchRowIndex;
+
 	uint32 nextStripeNumber;
 	StripeInformation *currentStripeInfo;
 	uint32 currentLineNumber;
 } OrcFdwExecState;
 
 
+/*
+ * SubfieldPathContext keeps the state used while walking the query to find the
+ * sub-fields of the foreign table's columns referenced in the query.
+ */
+typedef struct SubfieldPathContext
+{
+	Index relationId;
+	int sublevelsUp;
+	bool wholeRow;
+	List *subfieldPathList;
+	List *mapKeyList;
+
+} SubfieldPathContext;
+
+
 /* Function declarations for foreign data wrapper */
 extern Datum orc_fdw_handler(PG_FUNCTION_ARGS);
 extern Datum orc_fdw_validator(PG_FUNCTION_ARGS);
+extern Datum orc_fdw_column_statistics(PG_FUNCTION_ARGS);
 
 
 #endif   /* orc_fdw_H */
@@ -3,6 +3,7 @@
 #include "orc_query.h"
 #include "orcUtil.h"
 
+#include <math.h>
 #include "access/skey.h"
 #include "catalog/pg_am.h"
 #include "catalog/pg_type.h"
@@ -17,6 +18,7 @@
 #include "utils/date.h"
 #include "utils/lsyscache.h"
 #include "utils/numeric.h"
+#include "utils/pg_locale.h"
 #include "utils/timestamp.h"
 
 static Expr * OrcFindArgumentOfType(List *argumentList, NodeTag argumentType);
@@ -25,7 +27,9 @@ static Node * BuildBaseConstraint(Var *variable);
 static OpExpr * MakeOpExpression(Var *variable, int16 strategyNumber);
 static Oid GetOperatorByType(Oid typeId, Oid accessMethodId, int16 strategyNumber);
 static void UpdateConstraint(Node *baseConstraint, Datum minValue, Datum maxValue);
-static int OrcGetStrideStatistics(Var *variable, RowIndexEntry *entry, Datum *min, Datum *max);
+static bool OrcCompileStrideCheck(StrideCheck *strideCheck, OpExpr *opExpression,
+		FieldReader *rowReader);
+static bool OrcStrideCheckRefutes(StrideCheck *strideCheck, ColumnStatistics *statistics);
 
 
 /*
@@ -311,7 +315,8 @@ OrcCreateStrideRestrictions(FieldReader* rowReader, int strideNo)
 		subfield = structReader->fields[subfieldIndex];
 
 		/* restrictions for complex types (like lists) are skipped */
-		if (subfield->required && !IsComplexType(subfield->kind))
+		if (subfield->required && !IsComplexType(subfield->kind) &&
+				StatisticsOrderMatches(subfield->psqlVariable))
 		{
 			rowIndex = subfield->rowIndex;
 			if (strideNo > rowIndex->n_entry)
@@ -323,8 +328,8 @@ OrcCreateStrideRestrictions(FieldReader* rowReader, int strideNo)
 			rowIndexEntry = rowIndex->entry[strideNo];
 			baseRestriction = BuildBaseConstraint(subfield->psqlVariable);
 
-			hasStatistics = OrcGetStrideStatistics(subfield->psqlVariable, rowIndexEntry, &minValue,
-					&maxValue);
+			hasStatistics = OrcGetColumnStatistics(subfield->psqlVariable,
+					rowIndexEntry->statistics, &minValue, &maxValue);
 
 			if (hasStatistics)
 			{
@@ -340,14 +345,594 @@ OrcCreateStrideRestrictions(FieldReader* rowReader, int strideNo)
 
 
 /*
- * Reads the min/max value from the row index entry into datum pointers
+ * Compiles the given restrictions, which are chosen by ApplicableOpExpressionList,
+ * into checks against the min/max statistics of strides. Operators are resolved
+ * and constants are converted once here, so checking a stride doesn't allocate
+ * memory or look up the catalogs. Restrictions on types or operators the checks
+ * don't cover are returned in the other restriction list, so strides can still
+ * be refuted by them with predicate_refuted_by.
+ *
+ * @param rowReader field reader for the whole row
+ * @param restrictionList restrictions of the query on the columns of the file
+ * @param strideCheckCount pointer to store the number of compiled checks
+ * @param otherRestrictionList pointer to store restrictions which aren't compiled
+ */
+StrideCheck *
+OrcCompileStrideChecks(FieldReader *rowReader, List *restrictionList, int *strideCheckCount,
+		List **otherRestrictionList)
+{
+	StructFieldReader *structReader = (StructFieldReader *) rowReader->fieldReader;
+	StrideCheck *strideChecks = NULL;
+	ListCell *restrictionCell = NULL;
+	int checkCount = 0;
+
+	*otherRestrictionList = NIL;
+
+	if (restrictionList != NIL)
+	{
+		strideChecks = palloc0(list_length(restrictionList) * sizeof(StrideCheck));
+	}
+
+	foreach(restrictionCell, restrictionList)
+	{
+		OpExpr *opExpression = (OpExpr *) lfirst(restrictionCell);
+		Var *column = (Var *) OrcFindArgumentOfType(opExpression->args, T_Var);
+
+		/* partition columns aren't in the file, so they have no statistics */
+		if (column == NULL || column->varattno > structReader->noOfFields)
+		{
+			continue;
+		}
+
+		if (OrcCompileStrideCheck(&strideChecks[checkCount], opExpression, rowReader))
+		{
+			checkCount++;
+		}
+		else
+		{
+			*otherRestrictionList = lappend(*otherRestrictionList, opExpression);
+		}
+	}
+
+	*strideCheckCount = checkCount;
+
+	return strideChecks;
+}
+
+
+/*
+ * Compiles a "column operator constant" restriction, in either order of its
+ * arguments, into the given stride check. Returns false if the column isn't
+ * read from the file, if the operator isn't the btree operator of the column's
+ * type, or if the statistics of the type can't be compared with the constant
+ * without conversion.
+ */
+static bool
+OrcCompileStrideCheck(StrideCheck *strideCheck, OpExpr *opExpression, FieldReader *rowReader)
+{
+	StructFieldReader *structReader = (StructFieldReader *) rowReader->fieldReader;
+	Node *leftOperand = (Node *) linitial(opExpression->args);
+	Node *rightOperand = (Node *) lsecond(opExpression->args);
+	Var *column = NULL;
+	Const *constant = NULL;
+	Oid operatorId = opExpression->opno;
+	Oid operatorClassId = InvalidOid;
+	Oid operatorFamily = InvalidOid;
+	int strategyNumber = 0;
+	bool negated = false;
+	FieldReader *columnReader = NULL;
+
+	if (list_length(opExpression->args) != 2)
+	{
+		return false;
+	}
+
+	/* commute the operator if the constant is on the left */
+	if (IsA(leftOperand, Var) && IsA(rightOperand, Const))
+	{
+		column = (Var *) leftOperand;
+		constant = (Const *) rightOperand;
+	}
+	else if (IsA(leftOperand, Const) && IsA(rightOperand, Var))
+	{
+		column = (Var *) rightOperand;
+		constant = (Const *) leftOperand;
+		operatorId = get_commutator(operatorId);
+	}
+	else
+	{
+		return false;
+	}
+
+	if (constant->constisnull || !OidIsValid(operatorId) || column->varattno <= 0 ||
+			column->varattno > structReader->noOfFields)
+	{
+		return false;
+	}
+
+	columnReader = structReader->fields[column->varattno - 1];
+	if (!columnReader->required || IsComplexType(columnReader->kind))
+	{
+		return false;
+	}
+
+	operatorClassId = GetDefaultOpClass(column->vartype, BTREE_AM_OID);
+	if (!OidIsValid(operatorClassId))
+	{
+		return false;
+	}
+
+	operatorFamily = get_opclass_family(operatorClassId);
+	strategyNumber = get_op_opfamily_strategy(operatorId, operatorFamily);
+
+	/* <> is the negator of the = operator of the family */
+	if (strategyNumber == 0 && OidIsValid(get_negator(operatorId)))
+	{
+		strategyNumber = get_op_opfamily_strategy(get_negator(operatorId), operatorFamily);
+		negated = (strategyNumber == BTEqualStrategyNumber);
+		if (!negated)
+		{
+			return false;
+		}
+	}
+
+	switch (strategyNumber)
+	{
+		case BTLessStrategyNumber:
+			strideCheck->queryOperator = ORC_QUERY_LT;
+			break;
+		case BTLessEqualStrategyNumber:
+			strideCheck->queryOperator = ORC_QUERY_LTE;
+			break;
+		case BTEqualStrategyNumber:
+			strideCheck->queryOperator = negated ? ORC_QUERY_NE : ORC_QUERY_EQ;
+			break;
+		case BTGreaterEqualStrategyNumber:
+			strideCheck->queryOperator = ORC_QUERY_GTE;
+			break;
+		case BTGreaterStrategyNumber:
+			strideCheck->queryOperator = ORC_QUERY_GT;
+			break;
+		default:
+			return false;
+	}
+
+	/* integers of all sizes are in the same operator family */
+	switch (column->vartype)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		{
+			strideCheck->statisticsKind = ORC_STATISTICS_INTEGER;
+
+			if (constant->consttype == INT2OID)
+			{
+				strideCheck->integerValue = DatumGetInt16(constant->constvalue);
+			}
+			else if (constant->consttype == INT4OID)
+			{
+				strideCheck->integerValue = DatumGetInt32(constant->constvalue);
+			}
+			else if (constant->consttype == INT8OID)
+			{
+				strideCheck->integerValue = DatumGetInt64(constant->constvalue);
+			}
+			else
+			{
+				return false;
+			}
+			break;
+		}
+		case FLOAT4OID:
+		case FLOAT8OID:
+		{
+			strideCheck->statisticsKind = ORC_STATISTICS_DOUBLE;
+
+			if (constant->consttype == FLOAT4OID)
+			{
+				strideCheck->doubleValue = DatumGetFloat4(constant->constvalue);
+			}
+			else if (constant->consttype == FLOAT8OID)
+			{
+				strideCheck->doubleValue = DatumGetFloat8(constant->constvalue);
+			}
+			else
+			{
+				return false;
+			}
+
+			/* NaN sorts after all other values in PostgreSQL, unlike in C */
+			if (isnan(strideCheck->doubleValue))
+			{
+				return false;
+			}
+			break;
+		}
+		case TEXTOID:
+		{
+			text *constantText = NULL;
+
+			/* string statistics are in byte order, which only C collations share */
+			if (constant->consttype != TEXTOID || !lc_collate_is_c(opExpression->inputcollid))
+			{
+				return false;
+			}
+
+			constantText = DatumGetTextPP(constant->constvalue);
+
+			strideCheck->statisticsKind = ORC_STATISTICS_STRING;
+			strideCheck->stringValue = VARDATA_ANY(constantText);
+			strideCheck->stringLength = VARSIZE_ANY_EXHDR(constantText);
+			strideCheck->collationId = opExpression->inputcollid;
+			break;
+		}
+		case DATEOID:
+		{
+			if (constant->consttype != DATEOID)
+			{
+				return false;
+			}
+
+			strideCheck->statisticsKind = ORC_STATISTICS_DATE;
+			strideCheck->integerValue = (int64) DatumGetDateADT(constant->constvalue) +
+					ORC_PSQL_EPOCH_IN_DAYS;
+			break;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+
+	strideCheck->columnNo = column->varattno - 1;
+
+	return true;
+}
+
+
+/*
+ * Returns true if one of the compiled checks refutes the min/max statistics of
+ * the given stride, so none of its rows can pass the quals.
+ *
+ * @param rowReader field reader for the whole row
+ * @param strideNo
+ * @param strideChecks checks compiled by OrcCompileStrideChecks
+ * @param strideCheckCount
+ */
+bool
+OrcStrideChecksRefute(FieldReader *rowReader, int strideNo, StrideCheck *strideChecks,
+		int strideCheckCount)
+{
+	StructFieldReader *structReader = (StructFieldReader *) rowReader->fieldReader;
+	int checkNo = 0;
+
+	for (checkNo = 0; checkNo < strideCheckCount; ++checkNo)
+	{
+		StrideCheck *strideCheck = &strideChecks[checkNo];
+		RowIndex *rowIndex = structReader->fields[strideCheck->columnNo]->rowIndex;
+
+		if (rowIndex == NULL || strideNo >= rowIndex->n_entry)
+		{
+			continue;
+		}
+
+		if (OrcStrideCheckRefutes(strideCheck, rowIndex->entry[strideNo]->statistics))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * Compares the constant of the check with the minimum and the maximum in the
+ * statistics, and returns true if no value in the range passes the check.
+ * Returns false if the statistics don't have the minimum and the maximum, as
+ * for strides with only nulls.
+ */
+static bool
+OrcStrideCheckRefutes(StrideCheck *strideCheck, ColumnStatistics *statistics)
+{
+	int minComparison = 0;
+	int maxComparison = 0;
+
+	if (statistics == NULL)
+	{
+		return false;
+	}
+
+	switch (strideCheck->statisticsKind)
+	{
+		case ORC_STATISTICS_INTEGER:
+		{
+			IntegerStatistics *integerStatistics = statistics->intstatistics;
+			int64 value = strideCheck->integerValue;
+
+			if (integerStatistics == NULL || !integerStatistics->has_minimum ||
+					!integerStatistics->has_maximum)
+			{
+				return false;
+			}
+
+			minComparison = (integerStatistics->minimum > value) -
+					(integerStatistics->minimum < value);
+			maxComparison = (integerStatistics->maximum > value) -
+					(integerStatistics->maximum < value);
+			break;
+		}
+		case ORC_STATISTICS_DOUBLE:
+		{
+			DoubleStatistics *doubleStatistics = statistics->doublestatistics;
+			double value = strideCheck->doubleValue;
+
+			if (doubleStatistics == NULL || !doubleStatistics->has_minimum ||
+					!doubleStatistics->has_maximum || isnan(doubleStatistics->minimum) ||
+					isnan(doubleStatistics->maximum))
+			{
+				return false;
+			}
+
+			minComparison = (doubleStatistics->minimum > value) -
+					(doubleStatistics->minimum < value);
+			maxComparison = (doubleStatistics->maximum > value) -
+					(doubleStatistics->maximum < value);
+			break;
+		}
+		case ORC_STATISTICS_STRING:
+		{
+			StringStatistics *stringStatistics = statistics->stringstatistics;
+
+			if (stringStatistics == NULL || stringStatistics->minimum == NULL ||
+					stringStatistics->maximum == NULL)
+			{
+				return false;
+			}
+
+			minComparison = varstr_cmp(stringStatistics->minimum,
+					strlen(stringStatistics->minimum), strideCheck->stringValue,
+					strideCheck->stringLength, strideCheck->collationId);
+			maxComparison = varstr_cmp(stringStatistics->maximum,
+					strlen(stringStatistics->maximum), strideCheck->stringValue,
+					strideCheck->stringLength, strideCheck->collationId);
+			break;
+		}
+		case ORC_STATISTICS_DATE:
+		{
+			DateStatistics *dateStatistics = statistics->datestatistics;
+			int64 value = strideCheck->integerValue;
+
+			if (dateStatistics == NULL || !dateStatistics->has_minimum ||
+					!dateStatistics->has_maximum)
+			{
+				return false;
+			}
+
+			minComparison = (dateStatistics->minimum > value) - (dateStatistics->minimum < value);
+			maxComparison = (dateStatistics->maximum > value) - (dateStatistics->maximum < value);
+			break;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+
+	switch (strideCheck->queryOperator)
+	{
+		case ORC_QUERY_EQ:
+			return minComparison > 0 || maxComparison < 0;
+		case ORC_QUERY_LT:
+			return minComparison >= 0;
+		case ORC_QUERY_LTE:
+			return minComparison > 0;
+		case ORC_QUERY_GT:
+			return maxComparison <= 0;
+		case ORC_QUERY_GTE:
+			return maxComparison < 0;
+		case ORC_QUERY_NE:
+			return minComparison == 0 && maxComparison == 0;
+		default:
+			return false;
+	}
+}
+
+
+/*
+ * Returns true if the min/max statistics of the given column are ordered like the
+ * column's values. ORC orders strings by their bytes, so the statistics of string
+ * columns are only used under the C and POSIX collations.
+ */
+bool
+StatisticsOrderMatches(Var *column)
+{
+	if (column->vartype == TEXTOID || column->vartype == VARCHAROID ||
+			column->vartype == BPCHAROID)
+	{
+		return lc_collate_is_c(column->varcollid);
+	}
+
+	return true;
+}
+
+
+/*
+ * Creates restrictions for the given columns from the min/max values of the file
+ * statistics in the footer, like the restrictions of a stride. Columns which have
+ * nulls in the file are left out, since a range restriction would refute an
+ * IS NULL qual on them.
+ *
+ * @param footer footer of the file
+ * @param columnList columns of the table used in the query
+ */
+List *
+OrcCreateFileRestrictions(Footer *footer, List *columnList)
+{
+	List *fileRestrictionList = NIL;
+	FieldType *rootType = footer->types[0];
+	ListCell *columnCell = NULL;
+
+	foreach(columnCell, columnList)
+	{
+		Var *column = (Var *) lfirst(columnCell);
+		ColumnStatistics *statistics = NULL;
+		Node *baseRestriction = NULL;
+		Datum minValue = 0;
+		Datum maxValue = 0;
+		uint32 orcColumnNo = 0;
+
+		if (column->varattno <= 0 || column->varattno > rootType->n_subtypes)
+		{
+			continue;
+		}
+
+		orcColumnNo = rootType->subtypes[column->varattno - 1];
+		if (orcColumnNo >= footer->n_statistics || orcColumnNo >= footer->n_types ||
+				IsComplexType(footer->types[orcColumnNo]->kind) ||
+				!StatisticsOrderMatches(column))
+		{
+			continue;
+		}
+
+		statistics = footer->statistics[orcColumnNo];
+		if (!statistics->has_numberofvalues ||
+				statistics->numberofvalues < footer->numberofrows)
+		{
+			continue;
+		}
+
+		baseRestriction = BuildBaseConstraint(column);
+
+		if (OrcGetColumnStatistics(column, statistics, &minValue, &maxValue))
+		{
+			UpdateConstraint(baseRestriction, minValue, maxValue);
+			fileRestrictionList = lappend(fileRestrictionList, baseRestriction);
+		}
+	}
+
+	return fileRestrictionList;
+}
+
+
+/*
+ * Creates the restriction which holds for all rows under a partition directory:
+ * the partition column equals the value in the directory name, or is null for
+ * the default partition. Returns NULL if the column's type has no equality
+ * operator to build the restriction with.
+ *
+ * @param column partition column of the table
+ * @param value value of the column in the directory name
+ * @param isNull true for the default partition
+ */
+Node *
+OrcCreatePartitionRestriction(Var *column, Datum value, bool isNull)
+{
+	OpExpr *equalExpr = NULL;
+	Const *valueConstant = NULL;
+	Oid typeId = (column->vartype == VARCHAROID) ? TEXTOID : column->vartype;
+	int16 typeLength = 0;
+	bool typeByValue = false;
+
+	if (isNull)
+	{
+		NullTest *nullTest = makeNode(NullTest);
+		nullTest->arg = (Expr *) column;
+		nullTest->nulltesttype = IS_NULL;
+		nullTest->argisrow = false;
+
+		return (Node *) nullTest;
+	}
+
+	if (!OidIsValid(GetDefaultOpClass(typeId, BTREE_AM_OID)))
+	{
+		return NULL;
+	}
+
+	equalExpr = MakeOpExpression(column, BTEqualStrategyNumber);
+	valueConstant = (Const *) get_rightop((Expr *) equalExpr);
+
+	get_typlenbyval(typeId, &typeLength, &typeByValue);
+	valueConstant->constlen = typeLength;
+	valueConstant->constbyval = typeByValue;
+	valueConstant->constvalue = value;
+	valueConstant->constisnull = false;
+
+	return (Node *) equalExpr;
+}
+
+
+/*
+ * Reads the min/max value from the column statistics of a stride or of the whole
+ * file into datum pointers
  *
  * @return 1 for success, 0 when min/max value cannot be obtained
  */
-static int
-OrcGetStrideStatistics(Var *variable, RowIndexEntry *entry, Datum *min, Datum *max)
+int
+OrcGetColumnStatistics(Var *variable, ColumnStatistics *statistics, Datum *min, Datum *max)
 {
-	ColumnStatistics* statistics = entry->statistics;
+	*min = 0;
+	*max = 0;
+
+	if (statistics == NULL)
+	{
+		return 0;
+	}
+
+	/* statistics of the type are missing if the column has only nulls */
+	switch (variable->vartype)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		{
+			if (statistics->intstatistics == NULL)
+			{
+				return 0;
+			}
+			break;
+		}
+		case FLOAT4OID:
+		case FLOAT8OID:
+		{
+			/*
+			 * Writers update the bounds with < and >, so they stay NaN once the
+			 * first value is NaN and no longer bound the rest of the values.
+			 */
+			if (statistics->doublestatistics == NULL ||
+					isnan(statistics->doublestatistics->minimum) ||
+					isnan(statistics->doublestatistics->maximum))
+			{
+				return 0;
+			}
+			break;
+		}
+		case BPCHAROID:
+		case VARCHAROID:
+		case TEXTOID:
+		{
+			if (statistics->stringstatistics == NULL ||
+					statistics->stringstatistics->minimum == NULL ||
+					statistics->stringstatistics->maximum == NULL)
+			{
+				return 0;
+			}
+			break;
+		}
+		case DATEOID:
+		{
+			if (statistics->datestatistics == NULL)
+			{
+				return 0;
+			}
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
 
 	switch (variable->vartype)
 	{
@@ -365,8 +950,8 @@ OrcGetStrideStatistics(Var *variable, RowIndexEntry *entry, Datum *min, Datum *m
 		}
 		case INT8OID:
 		{
-			*min = Int64GetDatum((int) statistics->intstatistics->minimum);
-			*max = Int64GetDatum((int) statistics->intstatistics->maximum);
+			*min = Int64GetDatum((int64) statistics->intstatistics->minimum);
+			*max = Int64GetDatum((int64) statistics->intstatistics->maximum);
 			return 1;
 		}
 		case FLOAT4OID:
@@ -404,6 +989,25 @@ OrcGetStrideStatistics(Var *variable, RowIndexEntry *entry, Datum *min, Datum *m
 			*max = CStringGetTextDatum(statistics->stringstatistics->maximum);
 			return 1;
 		}
+		case NUMERICOID:
+		{
+			DecimalStatistics *decimalStatistics = statistics->decimalstatistics;
+
+			if (decimalStatistics == NULL || decimalStatistics->minimum == NULL ||
+					decimalStatistics->maximum == NULL)
+			{
+				return 0;
+			}
+
+			/* values are rounded with the same type modifier when they are read */
+			*min = DirectFunctionCall3(numeric_in, CStringGetDatum(decimalStatistics->minimum),
+					ObjectIdGetDatum(InvalidOid),
+					Int32GetDatum(variable->vartypmod));
+			*max = DirectFunctionCall3(numeric_in, CStringGetDatum(decimalStatistics->maximum),
+					ObjectIdGetDatum(InvalidOid),
+					Int32GetDatum(variable->vartypmod));
+			return 1;
+		}
 		case DATEOID:
 		{
 			*min = DateADTGetDatum(statistics->datestatistics->minimum - ORC_PSQL_EPOCH_IN_DAYS);
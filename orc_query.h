@@ -24,8 +24,44 @@ typedef enum
 	ORC_QUERY_NE = 5
 } OrcQueryOperator;
 
+/* form of the min/max values in the statistics a stride check is compiled for */
+typedef enum
+{
+	ORC_STATISTICS_INTEGER = 0,
+	ORC_STATISTICS_DOUBLE = 1,
+	ORC_STATISTICS_STRING = 2,
+	ORC_STATISTICS_DATE = 3
+} OrcStatisticsKind;
+
+/*
+ * StrideCheck is a pushed down qual of the form "column operator constant",
+ * compiled once per scan to be checked against the min/max statistics of each
+ * stride. The constant is kept in the form the statistics keep the column's
+ * values in, so strides are checked without building expressions.
+ */
+typedef struct StrideCheck
+{
+	int columnNo;
+	OrcQueryOperator queryOperator;
+	OrcStatisticsKind statisticsKind;
+	int64 integerValue;
+	double doubleValue;
+	char *stringValue;
+	int stringLength;
+	Oid collationId;
+
+} StrideCheck;
+
 List * ApplicableOpExpressionList(RelOptInfo *baserel);
 List * OrcCreateStrideRestrictions(FieldReader* rowReader, int strideNo);
+List * OrcCreateFileRestrictions(Footer *footer, List *columnList);
+Node * OrcCreatePartitionRestriction(Var *column, Datum value, bool isNull);
 List * BuildRestrictInfoList(List *qualList);
+StrideCheck * OrcCompileStrideChecks(FieldReader *rowReader, List *restrictionList,
+		int *strideCheckCount, List **otherRestrictionList);
+bool OrcStrideChecksRefute(FieldReader *rowReader, int strideNo, StrideCheck *strideChecks,
+		int strideCheckCount);
+int OrcGetColumnStatistics(Var *variable, ColumnStatistics *statistics, Datum *min, Datum *max);
+bool StatisticsOrderMatches(Var *column);
 
 #endif /* ORC_QUERY_H_ */
@@ -1,10 +1,16 @@
 #include "postgres.h"
 
+#include <math.h>
+
+#include "access/htup_details.h"
 #include "catalog/pg_type.h"
+#include "lib/stringinfo.h"
+#include "mb/pg_wchar.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/date.h"
 #include "utils/datetime.h"
+#include "utils/json.h"
 #include "utils/lsyscache.h"
 
 #include "orc.pb-c.h"
@@ -12,6 +18,16 @@
 #include "fileReader.h"
 #include "orcUtil.h"
 
+/*
+ * Unscaled values of decimals are read into the widest unsigned integer the
+ * compiler supports, which covers the 38 digits of Hive decimals with 128 bits.
+ */
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 DecimalMagnitude;
+#else
+typedef uint64_t DecimalMagnitude;
+#endif
+
 /* forward declarations of static functions */
 static int ParseNanos(long serializedData);
 static int ReadVarLenInteger(FileStream *stream, uint64_t *data);
@@ -21,10 +37,38 @@ static int IntegerReaderInit(FieldType__Kind kind, StreamReader *intState);
 
 static char ReadBoolean(StreamReader *booleanReaderState);
 static int ReadByte(StreamReader *byteReaderState, uint8_t *result);
-static int ReadInteger(FieldType__Kind kind, StreamReader *intReaderState, uint64_t *result);
+static inline int ReadInteger(FieldType__Kind kind, StreamReader *intReaderState, uint64_t *result);
 static int ReadFloat(StreamReader *fpState, float *data);
 static int ReadDouble(StreamReader *fpState, double *data);
 static int ReadBinary(StreamReader *binaryReaderState, uint8_t *data, int length);
+static bool StreamReaderHasMore(StreamReader *streamReader);
+static int SkipBooleans(StreamReader *booleanReaderState, long count);
+static int SkipBytes(StreamReader *byteReaderState, long count);
+static int SkipIntegers(FieldType__Kind kind, StreamReader *intReaderState, long count);
+static int SkipLengthPrefixedValues(FieldType__Kind kind, StreamReader *lengthReader,
+		StreamReader *dataReader, long count);
+static int FillStringBatch(FieldReader *fieldReader);
+static int StringValueMaxSize(PrimitiveFieldReader *primitiveReader, int byteLength);
+static int FinishStringValue(FieldReader *fieldReader, char *value, int byteLength);
+static int ReadIntegerBatch(FieldType__Kind kind, StreamReader *intReaderState, uint64_t *values,
+		int maxCount);
+static int FillDateBatch(FieldReader *fieldReader);
+static int FillTimestampBatch(FieldReader *fieldReader);
+static int ReadDecimal(FieldReader *fieldReader, Datum *value);
+static ArrayType * ReadFixedWidthListItems(ListFieldReader *listReader, int itemCount);
+static ArrayType * ReadNestedListItems(ListFieldReader *listReader, int listSize);
+static void AppendNestedListItems(ListFieldReader *rootReader, FieldReader *fieldReader, int depth,
+		int *dimensions, int *dimensionCount, int *itemCount);
+static void ListItemArraysEnlarge(ListFieldReader *listReader, int itemCount);
+static void ListItemsCopyFromBatchArena(FieldReader *itemReader, Datum *itemValues,
+		bool *itemNulls, int itemCount);
+static bool StrideConstantValue(FieldReader *fieldReader, ColumnStatistics *statistics,
+		Datum *value);
+static bool MapKeyIsRequired(MapFieldReader *mapReader, text *key);
+static void AppendMapValueAsJson(StringInfo buffer, FieldReader *valueReader, Datum value);
+
+/* multipliers of the encoded nanoseconds indexed by their last 3 bits */
+static const int NanosScale[8] = { 1, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
 
 
 /*
@@ -37,21 +81,11 @@ static int ReadBinary(StreamReader *binaryReaderState, uint8_t *data, int length
 static int 
 ParseNanos(long serializedData)
 {
-	/* last 3 bits encode the # 0s in the number */
-	int zeros = 7 & (int) serializedData;
-	int result = (int) serializedData >> 3;
-	int zeroIterator = 0;
-
-	if (zeros != 0)
-	{
-		/* if last 3 bits (xyz) are not 0, this means we have to multiply the value with ((xyz) + 1) * 10 */
-		for (zeroIterator = 0; zeroIterator <= zeros; ++zeroIterator)
-		{
-			result *= 10;
-		}
-	}
-
-	return result;
+	/*
+	 * Last 3 bits (xyz) encode the # 0s in the number. If they are not 0, this means
+	 * we have to multiply the value with 10 ^ ((xyz) + 1).
+	 */
+	return ((int) serializedData >> 3) * NanosScale[7 & (int) serializedData];
 }
 
 
@@ -283,8 +317,8 @@ StreamReaderInit(StreamReader *streamReader, FieldType__Kind streamKind, FILE *f
 
 	if (streamReader->stream != NULL)
 	{
-		FileStreamReset(streamReader->stream, offset, limit, parameters->compressionBlockSize,
-			parameters->compressionKind);
+		FileStreamReset(streamReader->stream, file, offset, limit,
+				parameters->compressionBlockSize, parameters->compressionKind);
 	}
 	else
 	{
@@ -292,21 +326,28 @@ StreamReaderInit(StreamReader *streamReader, FieldType__Kind streamKind, FILE *f
 				parameters->compressionKind);
 	}
 
+	/*
+	 * Run headers are not read here. Readers find no items left in the current run
+	 * and read the header on their first access, so no I/O is done for the streams
+	 * which are never read, like the dictionary of a column in a skipped stripe.
+	 */
+	streamReader->noOfLeftItems = 0;
+	streamReader->data = 0;
+
 	switch (streamKind)
 	{
 		case FIELD_TYPE__KIND__BOOLEAN:
 		{
-			return BooleanReaderInit(streamReader);
+			streamReader->mask = 0;
+			return 0;
 		}
 		case FIELD_TYPE__KIND__BYTE:
-		{
-			return ByteReaderInit(streamReader);
-		}	
 		case FIELD_TYPE__KIND__SHORT:
 		case FIELD_TYPE__KIND__INT:
 		case FIELD_TYPE__KIND__LONG:
 		{
-			return IntegerReaderInit(streamKind, streamReader);
+			streamReader->step = 0;
+			return 0;
 		}	
 		case FIELD_TYPE__KIND__FLOAT:
 		case FIELD_TYPE__KIND__DOUBLE:
@@ -334,7 +375,6 @@ void
 StreamReaderSeek(StreamReader *streamReader, FieldType__Kind fieldType,
 		FieldType__Kind streamKind, OrcStack *stack)
 {
-	int dataIndex = 0;
 	long* positionInRun = NULL;
 
 
@@ -342,18 +382,23 @@ StreamReaderSeek(StreamReader *streamReader, FieldType__Kind fieldType,
 	FileStreamSkip(streamReader->stream, stack);
 
 	/*
-	 * Then switch by looking at the stream kind to initialize the stream readers.
-	 * Some streams use run-length encoding to encode the values, so also get
-	 * the current position in the run and jump to that position.
+	 * The reader is now at the start of a run header. Mark the current run as
+	 * consumed so that the header is read by the skip functions below.
+	 */
+	streamReader->noOfLeftItems = 0;
+	streamReader->data = 0;
+
+	/*
+	 * Then switch by looking at the stream kind to jump to the current position
+	 * in the run. Runs are skipped without decoding the values in them.
 	 */
 	switch (streamKind)
 	{
 		case FIELD_TYPE__KIND__BOOLEAN:
 		{
 			long* bitsRead = NULL;
-			int booleanPosition = 0;
 
-			BooleanReaderInit(streamReader);
+			streamReader->mask = 0;
 
 			positionInRun = OrcStackPop(stack);
 			if (positionInRun == NULL)
@@ -369,33 +414,29 @@ StreamReaderSeek(StreamReader *streamReader, FieldType__Kind fieldType,
 
 			/* 
 			 * positionInRun gives the current byte in the run. bitsRead gives the # of
-			 * bits read in that byte. So we have to read the following number of bits
-			 * from the stream
+			 * bits read in that byte. So we have to skip the following number of bits
+			 * in the stream
 			 */
-			booleanPosition = *positionInRun * 8 + *bitsRead;
-
-			for (dataIndex = 0; dataIndex < booleanPosition; ++dataIndex)
+			if (SkipBooleans(streamReader, *positionInRun * 8 + *bitsRead))
 			{
-				ReadBoolean(streamReader);
+				LogError("Error occurred while skipping in the run");
 			}
 
 			break;
 		}
 		case FIELD_TYPE__KIND__BYTE:
 		{
-			uint8_t data8 = 0;
+			streamReader->step = 0;
 
-			ByteReaderInit(streamReader);
 			positionInRun = OrcStackPop(stack);
-
 			if (positionInRun == NULL)
 			{
 				LogError("Error occurred while getting position in the run");
 			}
 
-			for (dataIndex = 0; dataIndex < *positionInRun; ++dataIndex)
+			if (SkipBytes(streamReader, *positionInRun))
 			{
-				ReadByte(streamReader, &data8);
+				LogError("Error occurred while skipping in the run");
 			}
 
 			break;
@@ -404,9 +445,7 @@ StreamReaderSeek(StreamReader *streamReader, FieldType__Kind fieldType,
 		case FIELD_TYPE__KIND__INT:
 		case FIELD_TYPE__KIND__LONG:
 		{
-			uint64_t data64 = 0;
-
-			IntegerReaderInit(streamKind, streamReader);
+			streamReader->step = 0;
 
 			positionInRun = OrcStackPop(stack);
 			if (positionInRun == NULL)
@@ -414,9 +453,9 @@ StreamReaderSeek(StreamReader *streamReader, FieldType__Kind fieldType,
 				LogError("Error occurred while getting position in the run");
 			}
 
-			for (dataIndex = 0; dataIndex < *positionInRun; ++dataIndex)
+			if (SkipIntegers(fieldType, streamReader, *positionInRun))
 			{
-				ReadInteger(fieldType, streamReader, &data64);
+				LogError("Error occurred while skipping in the run");
 			}
 
 			break;
@@ -436,6 +475,166 @@ StreamReaderSeek(StreamReader *streamReader, FieldType__Kind fieldType,
 }
 
 
+/**
+ * Skips boolean values in the stream. Bits left in the current byte are dropped
+ * from the mask, whole bytes are jumped over in runs and literal groups, and the
+ * last partial byte is loaded once with its mask shifted to the next unread bit.
+ *
+ * @param booleanReaderState boolean reader
+ * @param count no of values to skip
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+SkipBooleans(StreamReader *booleanReaderState, long count)
+{
+	/* first drop the bits left in the current byte */
+	while (booleanReaderState->mask != 0 && count > 0)
+	{
+		booleanReaderState->mask >>= 1;
+		count--;
+	}
+
+	while (count >= 8)
+	{
+		long byteCount = 0;
+
+		if (booleanReaderState->noOfLeftItems == 0)
+		{
+			/* initializing the reader loads the first byte of the run, drop it as a whole */
+			if (BooleanReaderInit(booleanReaderState))
+			{
+				return -1;
+			}
+
+			booleanReaderState->mask = 0;
+			count -= 8;
+			continue;
+		}
+
+		byteCount = Min(count / 8, (long) booleanReaderState->noOfLeftItems);
+
+		if (booleanReaderState->currentEncodingType == VARIABLE_LENGTH &&
+				FileStreamSkipBytes(booleanReaderState->stream, byteCount))
+		{
+			return -1;
+		}
+
+		booleanReaderState->noOfLeftItems -= byteCount;
+		count -= byteCount * 8;
+	}
+
+	if (count > 0)
+	{
+		/* load the byte which contains the next value and jump to its bit */
+		if (ReadBoolean(booleanReaderState) < 0)
+		{
+			return -1;
+		}
+
+		booleanReaderState->mask >>= (count - 1);
+	}
+
+	return 0;
+}
+
+
+/**
+ * Skips byte values in the stream. Repeated runs are skipped by only changing
+ * the number of items left in them, literal groups are skipped in bulk.
+ *
+ * @param byteReaderState byte reader
+ * @param count no of values to skip
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+SkipBytes(StreamReader *byteReaderState, long count)
+{
+	while (count > 0)
+	{
+		long skipCount = 0;
+
+		if (byteReaderState->noOfLeftItems == 0 && ByteReaderInit(byteReaderState))
+		{
+			return -1;
+		}
+
+		skipCount = Min(count, (long) byteReaderState->noOfLeftItems);
+
+		if (byteReaderState->currentEncodingType == VARIABLE_LENGTH &&
+				FileStreamSkipBytes(byteReaderState->stream, skipCount))
+		{
+			return -1;
+		}
+
+		byteReaderState->noOfLeftItems -= skipCount;
+		count -= skipCount;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Skips integer values in the stream. Repeated runs are skipped by an arithmetic
+ * jump of the current value, literal groups are skipped without decoding the
+ * variable length integers in them.
+ *
+ * @param kind to detect the sign
+ * @param intReaderState integer reader
+ * @param count no of values to skip
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+SkipIntegers(FieldType__Kind kind, StreamReader *intReaderState, long count)
+{
+	while (count > 0)
+	{
+		long skipCount = 0;
+
+		if (intReaderState->noOfLeftItems == 0 && IntegerReaderInit(kind, intReaderState))
+		{
+			return -1;
+		}
+
+		skipCount = Min(count, (long) intReaderState->noOfLeftItems);
+
+		if (intReaderState->currentEncodingType == VARIABLE_LENGTH)
+		{
+			if (FileStreamSkipVarInts(intReaderState->stream, skipCount))
+			{
+				return -1;
+			}
+		}
+		else
+		{
+			int64_t delta = (int64_t) intReaderState->step * skipCount;
+
+			/* same as adding the step skipCount times as ReadInteger does */
+			switch (kind)
+			{
+			case FIELD_TYPE__KIND__SHORT:
+			case FIELD_TYPE__KIND__INT:
+			case FIELD_TYPE__KIND__LONG:
+				intReaderState->data =
+						ToUnsignedInteger(ToSignedInteger(intReaderState->data) + delta);
+				break;
+			default:
+				intReaderState->data += delta;
+				break;
+			}
+		}
+
+		intReaderState->noOfLeftItems -= skipCount;
+		count -= skipCount;
+	}
+
+	return 0;
+}
+
+
 /**
  * Reads a boolean value from the stream.
  *
@@ -536,7 +735,7 @@ ReadByte(StreamReader *byteReaderState, uint8_t *result)
  *
  * @return 0 for success, -1 for failure
  */
-static int 
+static inline int
 ReadInteger(FieldType__Kind kind, StreamReader *intReaderState, uint64_t *result)
 {
 	int bytesRead = 0;
@@ -666,6 +865,18 @@ ReadBinary(StreamReader *binaryReaderState, uint8_t *data, int length)
 }
 
 
+/**
+ * Checks whether there are values left to read in a run-length encoded stream.
+ *
+ * @return true if either the current run or the stream has more values
+ */
+static bool
+StreamReaderHasMore(StreamReader *streamReader)
+{
+	return streamReader->noOfLeftItems > 0 || !FileStreamEOF(streamReader->stream);
+}
+
+
 /**
  * Get the stream type of each data stream of a data type
  */
@@ -754,7 +965,22 @@ GetStreamKind(FieldType__Kind type, ColumnEncoding__Kind encoding, int streamInd
 			}
 			break;
 		}
+		case FIELD_TYPE__KIND__DECIMAL:
+		{
+			/* unscaled values are variable length integers of any size, they are read as bytes */
+			switch (streamIndex)
+			{
+			case 0:
+				return FIELD_TYPE__KIND__BINARY;
+			case 1:
+				return FIELD_TYPE__KIND__INT;
+			default:
+				return -1;
+			}
+			break;
+		}
 		case FIELD_TYPE__KIND__LIST:
+		case FIELD_TYPE__KIND__MAP:
 		{
 			return streamIndex ? -1 : FIELD_TYPE__KIND__INT;
 		}
@@ -801,7 +1027,12 @@ GetStreamCount(FieldType__Kind type, ColumnEncoding__Kind encoding)
 		{
 			return TIMESTAMP_STREAM_COUNT;
 		}
+		case FIELD_TYPE__KIND__DECIMAL:
+		{
+			return DECIMAL_STREAM_COUNT;
+		}
 		case FIELD_TYPE__KIND__LIST:
+		case FIELD_TYPE__KIND__MAP:
 		{
 			/* for length */
 			return 1;
@@ -818,8 +1049,43 @@ GetStreamCount(FieldType__Kind type, ColumnEncoding__Kind encoding)
 }
 
 
+/*
+ * Converts a C string into the text, varchar or bpchar datum of the field's PostgreSQL type.
+ */
+static Datum
+CStringGetStringDatum(FieldReader *fieldReader, char *value)
+{
+	switch (OrcGetPSQLType(fieldReader))
+	{
+		case BPCHAROID:
+		{
+			return DirectFunctionCall3(bpcharin, CStringGetDatum(value),
+					ObjectIdGetDatum(InvalidOid),
+					Int32GetDatum(OrcGetPSQLTypeMod(fieldReader)));
+		}
+		case VARCHAROID:
+		{
+			return DirectFunctionCall3(varcharin, CStringGetDatum(value),
+					ObjectIdGetDatum(InvalidOid),
+					Int32GetDatum(OrcGetPSQLTypeMod(fieldReader)));
+		}
+		case TEXTOID:
+		default:
+		{
+			return CStringGetTextDatum(value);
+		}
+	}
+}
+
+
 /*
  * Reads all strings of a dictionary encoded string column into the main memory.
+ * This is done when the first value of the column in the stripe is read.
+ *
+ * Items are converted into varlena datums of the column's type only once per stripe
+ * and stored back to back in one arena, so reading a row only returns a pointer
+ * computed from the item's offset. The offsets array and the arena are allocated
+ * when the stripe is opened and are only grown here.
  */
 void
 FillDictionary(FieldReader* stringFieldReader)
@@ -827,100 +1093,580 @@ FillDictionary(FieldReader* stringFieldReader)
 	PrimitiveFieldReader *primitiveFieldReader = (PrimitiveFieldReader *) stringFieldReader->fieldReader;
 	StreamReader *integerStreamReader = NULL;
 	StreamReader *binaryStreamReader = NULL;
+	int dictionarySize = primitiveFieldReader->dictionarySize;
+	int *itemOffsets = primitiveFieldReader->dictionaryOffsets;
+	long arenaSize = 0;
+	long arenaLength = 0;
 	uint64_t wordLength = 0;
 	int dictionaryIndex = 0;
 	int result = 0;
 
-	/* if dictionary is NULL, read the whole dictionary to the memory */
-	primitiveFieldReader->dictionary =
-			alloc(sizeof(char *) * primitiveFieldReader->dictionarySize);
-	primitiveFieldReader->wordLength =
-			alloc(sizeof(int) * primitiveFieldReader->dictionarySize);
 	integerStreamReader = &primitiveFieldReader->readers[LENGTH_STREAM];
 	binaryStreamReader = &primitiveFieldReader->readers[DICTIONARY_DATA_STREAM];
 
-	/* read the dictionary items one by one*/
-	for (dictionaryIndex = 0; dictionaryIndex < primitiveFieldReader->dictionarySize;
-			++dictionaryIndex)
+	/*
+	 * First read all item lengths to size the arena. Since lengths cannot be negative,
+	 * they are used directly. Item offsets temporarily hold the lengths.
+	 */
+	for (dictionaryIndex = 0; dictionaryIndex < dictionarySize; ++dictionaryIndex)
 	{
-		/*
-		 * First read dictionary item length. Since lengths cannot be negative,
-		 * directly use that number.
-		 */
 		result = ReadInteger(stringFieldReader->kind, integerStreamReader, &wordLength);
 		if (result < 0)
 		{
 			LogError("Error occurred while reading dictionary item length");
 		}
 
-		/* set the word length and allocate memory for the item */
-		primitiveFieldReader->wordLength[dictionaryIndex] = (int) wordLength;
-		primitiveFieldReader->dictionary[dictionaryIndex] = alloc(wordLength + 1);
+		itemOffsets[dictionaryIndex] = (int) wordLength;
+		arenaSize += INTALIGN(StringValueMaxSize(primitiveFieldReader, (int) wordLength));
+	}
+
+	if (primitiveFieldReader->dictionaryArenaSize < arenaSize)
+	{
+		primitiveFieldReader->dictionaryArena =
+				reAllocateMemory(primitiveFieldReader->dictionaryArena, arenaSize);
+		primitiveFieldReader->dictionaryArenaSize = arenaSize;
+	}
+
+	/*
+	 * Read the items from the file directly into their varlenas in the arena. Length
+	 * limits of CHAR(n) and VARCHAR(n) are checked, and CHAR(n) values are padded,
+	 * once per stripe here.
+	 */
+	for (dictionaryIndex = 0; dictionaryIndex < dictionarySize; ++dictionaryIndex)
+	{
+		char *item = primitiveFieldReader->dictionaryArena + arenaLength;
 
-		/* read the item from the file */
-		result = ReadBinary(binaryStreamReader,
-				(uint8_t *) primitiveFieldReader->dictionary[dictionaryIndex], (int) wordLength);
+		wordLength = (uint64_t) itemOffsets[dictionaryIndex];
 
+		result = ReadBinary(binaryStreamReader, (uint8_t *) VARDATA(item), (int) wordLength);
 		if (result < 0)
 		{
 			LogError("Error occurred while reading dictionary item");
 		}
 
-		primitiveFieldReader->dictionary[dictionaryIndex][wordLength] = '\0';
+		itemOffsets[dictionaryIndex] = (int) arenaLength;
+		arenaLength += INTALIGN(FinishStringValue(stringFieldReader, item, (int) wordLength));
 	}
+
+	primitiveFieldReader->dictionaryLoaded = 1;
 }
 
 /*
- * Reads a primitive field from the reader and returns it as a Datum.
+ * Decodes the next batch of direct encoded strings. Lengths of the batch are read
+ * first and prefix summed into the offsets of the values in the batch arena. Then
+ * each value is copied from the data stream directly into its varlena.
  *
- * @param isNull pointer to store whether the field is null or not
+ * @return 0 for success, -1 for failure
  */
-Datum 
-ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull)
+static int
+FillStringBatch(FieldReader *fieldReader)
 {
-	Datum columnValue = 0;
 	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
-	StreamReader *integerStreamReader = NULL;
+	StreamReader *lengthStreamReader = &primitiveReader->readers[LENGTH_STREAM];
+	StreamReader *binaryStreamReader = &primitiveReader->readers[DATA_STREAM];
+	Datum *batchValues = primitiveReader->batchValues;
+	uint64_t wordLength = 0;
+	long arenaSize = 0;
+	long arenaLength = 0;
+	int batchLength = 0;
+	int valueIndex = 0;
 	int result = 0;
 
-	/* first check if the field has a present bit stream */
-	if (fieldReader->hasPresentBitReader)
+	/* first read the lengths of the batch, values of the batch temporarily hold them */
+	while (batchLength < STRING_BATCH_SIZE && StreamReaderHasMore(lengthStreamReader))
 	{
-		StreamReader *presentStreamReader = &fieldReader->presentBitReader;
-		char isPresent = ReadBoolean(presentStreamReader);
-
-		if (isPresent == 0)
+		result = ReadInteger(fieldReader->kind, lengthStreamReader, &wordLength);
+		if (result)
 		{
-			*isNull = true;
-			return 0;
+			return -1;
 		}
-		else if (isPresent < 0)
+
+		batchValues[batchLength] = (Datum) wordLength;
+		arenaSize += INTALIGN(StringValueMaxSize(primitiveReader, (int) wordLength));
+		batchLength++;
+	}
+
+	if (batchLength == 0)
+	{
+		return -1;
+	}
+
+	/* previous batch is consumed, so the arena can be moved if it is too small */
+	if (primitiveReader->batchArenaSize < arenaSize)
+	{
+		primitiveReader->batchArenaSize = Max(arenaSize, primitiveReader->batchArenaSize * 2);
+		primitiveReader->batchArena = reAllocateMemory(primitiveReader->batchArena,
+				primitiveReader->batchArenaSize);
+	}
+
+	for (valueIndex = 0; valueIndex < batchLength; ++valueIndex)
+	{
+		char *value = primitiveReader->batchArena + arenaLength;
+		int valueLength = (int) batchValues[valueIndex];
+
+		result = ReadBinary(binaryStreamReader, (uint8_t *) VARDATA(value), valueLength);
+		if (result)
 		{
-			LogError("Error occurred while reading present bit stream");
 			return -1;
 		}
+
+		batchValues[valueIndex] = PointerGetDatum(value);
+		arenaLength += INTALIGN(FinishStringValue(fieldReader, value, valueLength));
 	}
 
-	switch (OrcGetPSQLType(fieldReader))
+	primitiveReader->batchLength = batchLength;
+	primitiveReader->batchPosition = 0;
+
+	return 0;
+}
+
+
+/*
+ * Returns the maximum size of the varlena of a string with the given byte length,
+ * including the padding of CHAR(n).
+ */
+static int
+StringValueMaxSize(PrimitiveFieldReader *primitiveReader, int byteLength)
+{
+	if (primitiveReader->stringPadded)
 	{
-		case BOOLOID:
+		return VARHDRSZ + byteLength + primitiveReader->stringMaxLength;
+	}
+
+	return VARHDRSZ + byteLength;
+}
+
+
+/*
+ * Completes the varlena of a string whose bytes are already read into its data.
+ * CHAR(n) values are padded with spaces, and values of CHAR(n) and VARCHAR(n)
+ * which may be longer than the limit are passed to the type's input function
+ * which truncates trailing spaces or errors out. The value must have room for
+ * StringValueMaxSize bytes.
+ *
+ * @return size of the varlena
+ */
+static int
+FinishStringValue(FieldReader *fieldReader, char *value, int byteLength)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	int maxLength = primitiveReader->stringMaxLength;
+	int characterLength = byteLength;
+	char *inputValue = NULL;
+	Datum inputDatum = 0;
+	int valueSize = 0;
+
+	/* no of characters is never more than no of bytes */
+	if (maxLength < 0 || (byteLength <= maxLength && !primitiveReader->stringPadded))
+	{
+		SET_VARSIZE(value, VARHDRSZ + byteLength);
+		return VARHDRSZ + byteLength;
+	}
+
+	if (!primitiveReader->singleByteEncoding)
+	{
+		characterLength = pg_mbstrlen_with_len(VARDATA(value), byteLength);
+	}
+
+	if (characterLength <= maxLength)
+	{
+		if (primitiveReader->stringPadded)
 		{
-			StreamReader *booleanStreamReader = &primitiveReader->readers[DATA_STREAM];
-			columnValue = BoolGetDatum(ReadBoolean(booleanStreamReader));
-			break;
+			memset(VARDATA(value) + byteLength, ' ', maxLength - characterLength);
+			byteLength += maxLength - characterLength;
 		}
-		case INT2OID: case INT4OID: case INT8OID: 
-		{
-			int64_t data64 = 0;
-			uint64_t udata64 = 0;
-			integerStreamReader = &primitiveReader->readers[DATA_STREAM];
 
-			result = ReadInteger(fieldReader->kind, integerStreamReader, &udata64);
+		SET_VARSIZE(value, VARHDRSZ + byteLength);
+		return VARHDRSZ + byteLength;
+	}
 
-			/* convert the integer to the signed form */
-			data64 = ToSignedInteger(udata64);
+	/* the input function can only make the value shorter */
+	inputValue = pnstrdup(VARDATA(value), byteLength);
+	inputDatum = CStringGetStringDatum(fieldReader, inputValue);
+	valueSize = VARSIZE(DatumGetPointer(inputDatum));
 
-			switch (OrcGetPSQLType(fieldReader))
+	memcpy(value, DatumGetPointer(inputDatum), valueSize);
+
+	freeMemory(inputValue);
+	freeMemory(DatumGetPointer(inputDatum));
+
+	return valueSize;
+}
+
+
+/**
+ * Decodes up to maxCount integers from the stream into the given vector. Values of
+ * repeated runs are generated in a loop without reading the stream again.
+ *
+ * @param kind to detect the sign
+ * @param intReaderState integer reader
+ * @param values vector to store the values in the same form as ReadInteger
+ * @param maxCount size of the vector
+ *
+ * @return no of values decoded, -1 for failure
+ */
+static int
+ReadIntegerBatch(FieldType__Kind kind, StreamReader *intReaderState, uint64_t *values,
+		int maxCount)
+{
+	int valueCount = 0;
+
+	while (valueCount < maxCount && StreamReaderHasMore(intReaderState))
+	{
+		int runCount = 0;
+		int runIndex = 0;
+
+		if (intReaderState->noOfLeftItems == 0 && IntegerReaderInit(kind, intReaderState))
+		{
+			return -1;
+		}
+
+		runCount = Min(maxCount - valueCount, (int) intReaderState->noOfLeftItems);
+
+		if (intReaderState->currentEncodingType == VARIABLE_LENGTH)
+		{
+			for (runIndex = 0; runIndex < runCount; ++runIndex)
+			{
+				if (ReadVarLenInteger(intReaderState->stream, &values[valueCount + runIndex]) <= 0)
+				{
+					return -1;
+				}
+			}
+		}
+		else
+		{
+			int64_t step = intReaderState->step;
+
+			switch (kind)
+			{
+			case FIELD_TYPE__KIND__SHORT:
+			case FIELD_TYPE__KIND__INT:
+			case FIELD_TYPE__KIND__LONG:
+			{
+				int64_t start = ToSignedInteger(intReaderState->data);
+
+				for (runIndex = 0; runIndex < runCount; ++runIndex)
+				{
+					values[valueCount + runIndex] = ToUnsignedInteger(start + step * runIndex);
+				}
+
+				intReaderState->data = ToUnsignedInteger(start + step * runCount);
+				break;
+			}
+			default:
+			{
+				uint64_t start = intReaderState->data;
+
+				for (runIndex = 0; runIndex < runCount; ++runIndex)
+				{
+					values[valueCount + runIndex] = start + step * runIndex;
+				}
+
+				intReaderState->data = start + step * runCount;
+				break;
+			}
+			}
+		}
+
+		intReaderState->noOfLeftItems -= runCount;
+		valueCount += runCount;
+	}
+
+	return valueCount;
+}
+
+
+/*
+ * Decodes the next batch of dates. Days are read into the batch and converted to
+ * the PostgreSQL epoch in one pass.
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+FillDateBatch(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	uint64_t *days = (uint64_t *) primitiveReader->batchValues;
+	int batchLength = 0;
+	int valueIndex = 0;
+
+	batchLength = ReadIntegerBatch(FIELD_TYPE__KIND__INT, &primitiveReader->readers[DATA_STREAM],
+			days, STRING_BATCH_SIZE);
+	if (batchLength <= 0)
+	{
+		return -1;
+	}
+
+	for (valueIndex = 0; valueIndex < batchLength; ++valueIndex)
+	{
+		int64_t dayValue = ToSignedIntegerBatch(days[valueIndex]) - ORC_PSQL_EPOCH_IN_DAYS;
+		primitiveReader->batchValues[valueIndex] = DateADTGetDatum((DateADT) dayValue);
+	}
+
+	primitiveReader->batchLength = batchLength;
+	primitiveReader->batchPosition = 0;
+
+	return 0;
+}
+
+
+/*
+ * Decodes the next batch of timestamps. Seconds and nanoseconds are read into
+ * separate vectors first, then they are combined and converted to the PostgreSQL
+ * epoch in one pass without branches.
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+FillTimestampBatch(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	uint64_t *seconds = (uint64_t *) primitiveReader->batchValues;
+	uint64_t *nanos = primitiveReader->batchSecondaryValues;
+	int batchLength = 0;
+	int valueIndex = 0;
+
+	batchLength = ReadIntegerBatch(FIELD_TYPE__KIND__LONG, &primitiveReader->readers[DATA_STREAM],
+			seconds, STRING_BATCH_SIZE);
+	if (batchLength <= 0)
+	{
+		return -1;
+	}
+
+	/* nano seconds stream has exactly one value for each seconds value */
+	if (ReadIntegerBatch(FIELD_TYPE__KIND__INT, &primitiveReader->readers[SECONDARY_STREAM],
+			nanos, batchLength) != batchLength)
+	{
+		return -1;
+	}
+
+	for (valueIndex = 0; valueIndex < batchLength; ++valueIndex)
+	{
+		int64_t secondValue = ToSignedIntegerBatch(seconds[valueIndex]) + ORC_DIFF_POSTGRESQL;
+		int64_t nanoValue = (int64_t) ((int) nanos[valueIndex] >> 3) *
+				NanosScale[nanos[valueIndex] & 7];
+
+		primitiveReader->batchValues[valueIndex] = TimestampGetDatum(
+				secondValue * MICROSECONDS_PER_SECOND + nanoValue / NANOSECONDS_PER_MICROSECOND);
+	}
+
+	primitiveReader->batchLength = batchLength;
+	primitiveReader->batchPosition = 0;
+
+	return 0;
+}
+
+
+/*
+ * Writes a 16 bit integer in network byte order, as pq_sendint does.
+ */
+static void
+AppendNetworkInt16(char *buffer, int *length, int16 value)
+{
+	buffer[(*length)++] = (char) ((value >> 8) & 0xFF);
+	buffer[(*length)++] = (char) (value & 0xFF);
+}
+
+
+/*
+ * Reads a decimal and converts it into a numeric datum. The unscaled value is a
+ * zigzag encoded variable length integer in the data stream and the scale is in
+ * the secondary stream. Base 10000 digits of PostgreSQL's numeric type are built
+ * directly from the unscaled value, and the result is passed to numeric_recv in
+ * the binary format, so no text is parsed.
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+ReadDecimal(FieldReader *fieldReader, Datum *value)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	FileStream *dataStream = primitiveReader->readers[DATA_STREAM].stream;
+	int magnitudeBits = sizeof(DecimalMagnitude) * 8;
+	DecimalMagnitude zigzagValue = 0;
+	DecimalMagnitude magnitude = 0;
+	bool isNegative = false;
+	int shift = 0;
+	char byte = 0;
+	uint64_t scaleData = 0;
+	int scale = 0;
+	char decimalDigits[MAX_DECIMAL_BASE_DIGITS];
+	int decimalDigitCount = 0;
+	int16 baseDigits[MAX_DECIMAL_BASE_DIGITS];
+	int lowestGroup = 0;
+	int highestGroup = 0;
+	int baseDigitCount = 0;
+	int digitIndex = 0;
+	char numericBuffer[4 * sizeof(int16) + MAX_DECIMAL_BASE_DIGITS * sizeof(int16)];
+	int numericLength = 0;
+	StringInfoData numericData;
+	static const int16 powersOfTen[NUMERIC_BASE_DIGITS] = { 1, 10, 100, 1000 };
+
+	/* read the unscaled value, bits which do not fit into the magnitude are an error */
+	do
+	{
+		int bits = 0;
+
+		if (FileStreamReadByte(dataStream, &byte))
+		{
+			return -1;
+		}
+
+		bits = byte & 0x7F;
+		if (shift >= magnitudeBits || (shift > magnitudeBits - 7 && (bits >> (magnitudeBits - shift))))
+		{
+			LogError("Decimal value is too large");
+		}
+
+		zigzagValue |= ((DecimalMagnitude) bits) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	if (ReadInteger(FIELD_TYPE__KIND__INT, &primitiveReader->readers[SECONDARY_STREAM], &scaleData))
+	{
+		return -1;
+	}
+
+	scale = (int) ToSignedInteger(scaleData);
+
+	/* zigzag decoding, the magnitude of the smallest negative value still fits */
+	isNegative = (zigzagValue & 1) != 0;
+	magnitude = (zigzagValue >> 1) + (isNegative ? 1 : 0);
+
+	/* decimal digits of the magnitude, least significant first; 64 bit arithmetic for each chunk */
+	while (magnitude != 0)
+	{
+		uint64_t chunk = 0;
+		bool lastChunk = (magnitude < DECIMAL_CHUNK_BASE);
+		int chunkDigit = 0;
+
+		if (lastChunk)
+		{
+			chunk = (uint64_t) magnitude;
+			magnitude = 0;
+		}
+		else
+		{
+			chunk = (uint64_t) (magnitude % DECIMAL_CHUNK_BASE);
+			magnitude /= DECIMAL_CHUNK_BASE;
+		}
+
+		for (chunkDigit = 0; chunkDigit < DECIMAL_CHUNK_DIGITS && (chunk != 0 || !lastChunk);
+				++chunkDigit)
+		{
+			decimalDigits[decimalDigitCount++] = (char) (chunk % 10);
+			chunk /= 10;
+		}
+	}
+
+	/*
+	 * Decimal digit i has the weight 10 ^ (i - scale). Digits are grouped into base
+	 * 10000 digits aligned on the decimal point.
+	 */
+	if (decimalDigitCount > 0)
+	{
+		lowestGroup = -scale >= 0 ? (-scale) / NUMERIC_BASE_DIGITS :
+				-((scale + NUMERIC_BASE_DIGITS - 1) / NUMERIC_BASE_DIGITS);
+		highestGroup = (decimalDigitCount - 1 - scale) >= 0 ?
+				(decimalDigitCount - 1 - scale) / NUMERIC_BASE_DIGITS :
+				-((scale - decimalDigitCount + 1 + NUMERIC_BASE_DIGITS - 1) / NUMERIC_BASE_DIGITS);
+		baseDigitCount = highestGroup - lowestGroup + 1;
+
+		if (baseDigitCount > MAX_DECIMAL_BASE_DIGITS)
+		{
+			LogError("Decimal scale is out of range");
+		}
+
+		memset(baseDigits, 0, baseDigitCount * sizeof(int16));
+
+		for (digitIndex = 0; digitIndex < decimalDigitCount; ++digitIndex)
+		{
+			int position = digitIndex - scale;
+			int group = (position - lowestGroup * NUMERIC_BASE_DIGITS) / NUMERIC_BASE_DIGITS;
+			int groupPosition = position - (lowestGroup + group) * NUMERIC_BASE_DIGITS;
+
+			/* base digits are stored most significant first */
+			baseDigits[baseDigitCount - 1 - group] += decimalDigits[digitIndex] *
+					powersOfTen[groupPosition];
+		}
+	}
+
+	/* header is digit count, weight, sign and display scale */
+	AppendNetworkInt16(numericBuffer, &numericLength, (int16) baseDigitCount);
+	AppendNetworkInt16(numericBuffer, &numericLength, (int16) highestGroup);
+	AppendNetworkInt16(numericBuffer, &numericLength,
+			(int16) (isNegative ? NUMERIC_NEGATIVE : NUMERIC_POSITIVE));
+	AppendNetworkInt16(numericBuffer, &numericLength, (int16) Max(scale, 0));
+
+	for (digitIndex = 0; digitIndex < baseDigitCount; ++digitIndex)
+	{
+		AppendNetworkInt16(numericBuffer, &numericLength, baseDigits[digitIndex]);
+	}
+
+	numericData.data = numericBuffer;
+	numericData.len = numericLength;
+	numericData.maxlen = sizeof(numericBuffer);
+	numericData.cursor = 0;
+
+	/* numeric_recv also applies the type modifier of the column */
+	*value = DirectFunctionCall3(numeric_recv, PointerGetDatum(&numericData),
+			ObjectIdGetDatum(InvalidOid), Int32GetDatum(OrcGetPSQLTypeMod(fieldReader)));
+
+	return 0;
+}
+
+
+/*
+ * Reads a primitive field from the reader and returns it as a Datum.
+ *
+ * @param isNull pointer to store whether the field is null or not
+ */
+Datum 
+ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull)
+{
+	Datum columnValue = 0;
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	StreamReader *integerStreamReader = NULL;
+	int result = 0;
+
+	/* first check if the field has a present bit stream */
+	if (fieldReader->hasPresentBitReader)
+	{
+		StreamReader *presentStreamReader = &fieldReader->presentBitReader;
+		char isPresent = ReadBoolean(presentStreamReader);
+
+		if (isPresent == 0)
+		{
+			*isNull = true;
+			return 0;
+		}
+		else if (isPresent < 0)
+		{
+			LogError("Error occurred while reading present bit stream");
+			return -1;
+		}
+	}
+
+	switch (OrcGetPSQLType(fieldReader))
+	{
+		case BOOLOID:
+		{
+			StreamReader *booleanStreamReader = &primitiveReader->readers[DATA_STREAM];
+			columnValue = BoolGetDatum(ReadBoolean(booleanStreamReader));
+			break;
+		}
+		case INT2OID: case INT4OID: case INT8OID: 
+		{
+			int64_t data64 = 0;
+			uint64_t udata64 = 0;
+			integerStreamReader = &primitiveReader->readers[DATA_STREAM];
+
+			result = ReadInteger(fieldReader->kind, integerStreamReader, &udata64);
+
+			/* convert the integer to the signed form */
+			data64 = ToSignedInteger(udata64);
+
+			switch (OrcGetPSQLType(fieldReader))
 			{
 				case INT2OID:
 				{
@@ -969,86 +1715,103 @@ ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 		case TEXTOID:
 		{
 			char* dictionaryItem = NULL;
+			StreamReader *binaryStreamReader = NULL;
+			uint64_t wordLength = 0;
 
 			/* check if the strings are dictionary encoded */
 			if (primitiveReader->hasDictionary)
 			{
 				uint64_t dictionaryIndex = 0;
 
+				if (!primitiveReader->dictionaryLoaded)
+				{
+					FillDictionary(fieldReader);
+				}
+
 				/* read the dictionary item position of the current string */
 				integerStreamReader = &primitiveReader->readers[DATA_STREAM];
 				result = ReadInteger(fieldReader->kind, integerStreamReader, &dictionaryIndex);
 
-				/* get the dictionary item by its position */
-				dictionaryItem = primitiveReader->dictionary[dictionaryIndex];
-			}
-			else
-			{
-				StreamReader *binaryStreamReader = NULL;
-				uint64_t wordLength = 0;
-
-				/* if direct encoding is used, just read the current string */
-				binaryStreamReader = &primitiveReader->readers[DATA_STREAM];
-				integerStreamReader = &primitiveReader->readers[LENGTH_STREAM];
-
-				/* read the length of the string */
-				result = ReadInteger(fieldReader->kind, integerStreamReader, &wordLength);
-				if (result < 0)
+				if (result == 0 && dictionaryIndex >= primitiveReader->dictionarySize)
 				{
-					LogError("Error occurred while reading string length");
-					return -1;
+					LogError("Dictionary item position is out of range");
 				}
 
-				dictionaryItem = alloc(wordLength + 1);
+				/* dictionary items are already converted, return the item by reference */
+				columnValue = PointerGetDatum(primitiveReader->dictionaryArena +
+						primitiveReader->dictionaryOffsets[dictionaryIndex]);
+				break;
+			}
 
-				/* read the string from the stream */
-				result = ReadBinary(binaryStreamReader, (uint8_t*) dictionaryItem, (int) wordLength);
-				if (result < 0)
+			/* return the next value of the batch if the strings are decoded in batches */
+			if (primitiveReader->batchValues != NULL)
+			{
+				if (primitiveReader->batchPosition >= primitiveReader->batchLength)
 				{
-					LogError("Error occurred while reading string");
-					return -1;
+					result = FillStringBatch(fieldReader);
+					if (result)
+					{
+						LogError("Error occurred while reading strings");
+						return -1;
+					}
 				}
 
-				dictionaryItem[wordLength] = '\0';
+				columnValue = primitiveReader->batchValues[primitiveReader->batchPosition];
+				primitiveReader->batchPosition++;
+				break;
 			}
 
-			/* convert the C string into the Datum format */
-			switch (OrcGetPSQLType(fieldReader))
+			/* if direct encoding is used, just read the current string */
+			binaryStreamReader = &primitiveReader->readers[DATA_STREAM];
+			integerStreamReader = &primitiveReader->readers[LENGTH_STREAM];
+
+			/* read the length of the string */
+			result = ReadInteger(fieldReader->kind, integerStreamReader, &wordLength);
+			if (result < 0)
 			{
-				case BPCHAROID:
-				{
-					columnValue = DirectFunctionCall3(bpcharin, CStringGetDatum(dictionaryItem),
-							ObjectIdGetDatum(InvalidOid),
-							Int32GetDatum(OrcGetPSQLTypeMod(fieldReader)));
-					break;
-				}
-				case VARCHAROID:
-				{
-					columnValue = DirectFunctionCall3(varcharin, CStringGetDatum(dictionaryItem),
-							ObjectIdGetDatum(InvalidOid),
-							Int32GetDatum(OrcGetPSQLTypeMod(fieldReader)));
-					break;
-				}
-				case TEXTOID:
-				{
-					columnValue = CStringGetTextDatum(dictionaryItem);
-					break;
-				}
-				default:
-				{
-					break;
-				}
+				LogError("Error occurred while reading string length");
+				return -1;
+			}
+
+			dictionaryItem = alloc(wordLength + 1);
+
+			/* read the string from the stream */
+			result = ReadBinary(binaryStreamReader, (uint8_t*) dictionaryItem, (int) wordLength);
+			if (result < 0)
+			{
+				LogError("Error occurred while reading string");
+				return -1;
 			}
 
+			dictionaryItem[wordLength] = '\0';
+
+			/* convert the C string into the Datum format */
+			columnValue = CStringGetStringDatum(fieldReader, dictionaryItem);
+
 			break;
 		}
 		case DATEOID:
 		{
 			uint64_t udata64 = 0;
 			int days = 0;
-			integerStreamReader = &primitiveReader->readers[DATA_STREAM];
 
-			result = ReadInteger(FIELD_TYPE__KIND__INT, integerStreamReader, &udata64);
+			/* return the next value of the batch if the dates are decoded in batches */
+			if (primitiveReader->batchValues != NULL)
+			{
+				if (primitiveReader->batchPosition >= primitiveReader->batchLength &&
+						FillDateBatch(fieldReader))
+				{
+					LogError("Error occurred while reading dates");
+				}
+
+				columnValue = primitiveReader->batchValues[primitiveReader->batchPosition];
+				primitiveReader->batchPosition++;
+				break;
+			}
+
+			integerStreamReader = &primitiveReader->readers[DATA_STREAM];
+
+			result = ReadInteger(FIELD_TYPE__KIND__INT, integerStreamReader, &udata64);
 
 			/* since days can be negative convert the number into signed format */
 			days = ToSignedInteger(udata64);
@@ -1067,6 +1830,20 @@ ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 			int64_t seconds = 0;
 			int newNanos = 0;
 
+			/* return the next value of the batch if the timestamps are decoded in batches */
+			if (primitiveReader->batchValues != NULL)
+			{
+				if (primitiveReader->batchPosition >= primitiveReader->batchLength &&
+						FillTimestampBatch(fieldReader))
+				{
+					LogError("Error occurred while reading timestamps");
+				}
+
+				columnValue = primitiveReader->batchValues[primitiveReader->batchPosition];
+				primitiveReader->batchPosition++;
+				break;
+			}
+
 			/* read seconds data of the timestamp */
 			integerStreamReader = &primitiveReader->readers[DATA_STREAM];
 			result = ReadInteger(FIELD_TYPE__KIND__LONG, integerStreamReader, &udata64);
@@ -1091,9 +1868,12 @@ ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 			break;
 		}
 		case NUMERICOID:
+		{
+			result = ReadDecimal(fieldReader, &columnValue);
+			break;
+		}
 		default:
 		{
-			/* numeric type is not supported right now */
 			result = -1;
 			break;
 		}
@@ -1111,6 +1891,245 @@ ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 }
 
 
+/**
+ * Skips values whose lengths are kept in a separate stream, like direct encoded
+ * strings. Lengths are read to sum the bytes to skip in the data stream.
+ *
+ * @return 0 for success, -1 for failure
+ */
+static int
+SkipLengthPrefixedValues(FieldType__Kind kind, StreamReader *lengthReader,
+		StreamReader *dataReader, long count)
+{
+	uint64_t valueLength = 0;
+	long totalLength = 0;
+	long valueIndex = 0;
+
+	for (valueIndex = 0; valueIndex < count; ++valueIndex)
+	{
+		if (ReadInteger(kind, lengthReader, &valueLength))
+		{
+			return -1;
+		}
+
+		totalLength += (long) valueLength;
+	}
+
+	return FileStreamSkipBytes(dataReader->stream, totalLength);
+}
+
+
+/*
+ * Skips the next rows of a field without converting them into datums. Values are
+ * skipped in the same order as they are read, so the streams of the field stay
+ * aligned with the rest of the row.
+ *
+ * @param fieldReader primitive or list field reader
+ * @param rowCount no of rows to skip
+ *
+ * @return 0 for success, -1 for failure
+ */
+int
+SkipFieldValues(FieldReader *fieldReader, long rowCount)
+{
+	PrimitiveFieldReader *primitiveReader = NULL;
+	long valueCount = rowCount;
+	long rowIndex = 0;
+	int result = 0;
+
+	/* streams of the stride are already passed over in these modes */
+	if (fieldReader->strideMode == STRIDE_MODE_CONSTANT ||
+			fieldReader->strideMode == STRIDE_MODE_ALL_NULLS)
+	{
+		return 0;
+	}
+
+	/* only non-null values are kept in the data streams */
+	if (fieldReader->hasPresentBitReader)
+	{
+		valueCount = 0;
+
+		for (rowIndex = 0; rowIndex < rowCount; ++rowIndex)
+		{
+			char isPresent = ReadBoolean(&fieldReader->presentBitReader);
+			if (isPresent < 0)
+			{
+				return -1;
+			}
+
+			valueCount += isPresent;
+		}
+	}
+
+	if (valueCount == 0)
+	{
+		return 0;
+	}
+
+	if (fieldReader->kind == FIELD_TYPE__KIND__STRUCT)
+	{
+		StructFieldReader *structReader = (StructFieldReader *) fieldReader->fieldReader;
+		int fieldIndex = 0;
+
+		/* sub-fields have values only for the rows where the struct is present */
+		for (fieldIndex = 0; fieldIndex < structReader->noOfFields; ++fieldIndex)
+		{
+			FieldReader *subfield = structReader->fields[fieldIndex];
+
+			if (subfield->required && SkipFieldValues(subfield, valueCount))
+			{
+				return -1;
+			}
+		}
+
+		return 0;
+	}
+	else if (fieldReader->kind == FIELD_TYPE__KIND__LIST)
+	{
+		ListFieldReader *listReader = (ListFieldReader *) fieldReader->fieldReader;
+		uint64_t listSize = 0;
+		long itemCount = 0;
+
+		for (rowIndex = 0; rowIndex < valueCount; ++rowIndex)
+		{
+			if (ReadInteger(fieldReader->kind, &listReader->lengthReader, &listSize))
+			{
+				return -1;
+			}
+
+			itemCount += (long) listSize;
+		}
+
+		return SkipFieldValues(&listReader->itemReader, itemCount);
+	}
+	else if (fieldReader->kind == FIELD_TYPE__KIND__MAP)
+	{
+		MapFieldReader *mapReader = (MapFieldReader *) fieldReader->fieldReader;
+		uint64_t mapSize = 0;
+		long entryCount = 0;
+
+		for (rowIndex = 0; rowIndex < valueCount; ++rowIndex)
+		{
+			if (ReadInteger(fieldReader->kind, &mapReader->lengthReader, &mapSize))
+			{
+				return -1;
+			}
+
+			entryCount += (long) mapSize;
+		}
+
+		if (SkipFieldValues(&mapReader->keyReader, entryCount))
+		{
+			return -1;
+		}
+
+		return SkipFieldValues(&mapReader->valueReader, entryCount);
+	}
+
+	primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+
+	/* values which are already decoded in the current batch are just passed over */
+	if (primitiveReader->batchValues != NULL)
+	{
+		long batchSkipCount = Min(valueCount,
+				(long) (primitiveReader->batchLength - primitiveReader->batchPosition));
+
+		primitiveReader->batchPosition += batchSkipCount;
+		valueCount -= batchSkipCount;
+
+		if (valueCount == 0)
+		{
+			return 0;
+		}
+	}
+
+	switch (fieldReader->kind)
+	{
+		case FIELD_TYPE__KIND__BOOLEAN:
+		{
+			result = SkipBooleans(&primitiveReader->readers[DATA_STREAM], valueCount);
+			break;
+		}
+		case FIELD_TYPE__KIND__BYTE:
+		{
+			result = SkipBytes(&primitiveReader->readers[DATA_STREAM], valueCount);
+			break;
+		}
+		case FIELD_TYPE__KIND__SHORT:
+		case FIELD_TYPE__KIND__INT:
+		case FIELD_TYPE__KIND__LONG:
+		{
+			result = SkipIntegers(fieldReader->kind, &primitiveReader->readers[DATA_STREAM],
+					valueCount);
+			break;
+		}
+		case FIELD_TYPE__KIND__DATE:
+		{
+			result = SkipIntegers(FIELD_TYPE__KIND__INT, &primitiveReader->readers[DATA_STREAM],
+					valueCount);
+			break;
+		}
+		case FIELD_TYPE__KIND__TIMESTAMP:
+		{
+			result = SkipIntegers(FIELD_TYPE__KIND__LONG, &primitiveReader->readers[DATA_STREAM],
+					valueCount);
+			if (result == 0)
+			{
+				result = SkipIntegers(FIELD_TYPE__KIND__INT,
+						&primitiveReader->readers[SECONDARY_STREAM], valueCount);
+			}
+			break;
+		}
+		case FIELD_TYPE__KIND__DECIMAL:
+		{
+			result = FileStreamSkipVarInts(primitiveReader->readers[DATA_STREAM].stream,
+					valueCount);
+			if (result == 0)
+			{
+				result = SkipIntegers(FIELD_TYPE__KIND__INT,
+						&primitiveReader->readers[SECONDARY_STREAM], valueCount);
+			}
+			break;
+		}
+		case FIELD_TYPE__KIND__FLOAT:
+		{
+			result = FileStreamSkipBytes(primitiveReader->readers[DATA_STREAM].stream,
+					valueCount * sizeof(float));
+			break;
+		}
+		case FIELD_TYPE__KIND__DOUBLE:
+		{
+			result = FileStreamSkipBytes(primitiveReader->readers[DATA_STREAM].stream,
+					valueCount * sizeof(double));
+			break;
+		}
+		case FIELD_TYPE__KIND__STRING:
+		case FIELD_TYPE__KIND__BINARY:
+		{
+			/* dictionary is not needed to skip its item positions */
+			if (primitiveReader->hasDictionary)
+			{
+				result = SkipIntegers(fieldReader->kind, &primitiveReader->readers[DATA_STREAM],
+						valueCount);
+				break;
+			}
+
+			result = SkipLengthPrefixedValues(fieldReader->kind,
+					&primitiveReader->readers[LENGTH_STREAM],
+					&primitiveReader->readers[DATA_STREAM], valueCount);
+			break;
+		}
+		default:
+		{
+			result = -1;
+			break;
+		}
+	}
+
+	return result;
+}
+
+
 /*
  * Reads a list field from the reader and returns it as a Datum.
  *
@@ -1124,7 +2143,6 @@ ReadListFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 	StreamReader* presentStreamReader = &fieldReader->presentBitReader;
 
 	Datum columnValue = 0;
-	Datum *datumArray = NULL;
 	int datumArraySize = 0;
 	uint64_t listSize = 0;
 	ArrayType *columnValueObject = NULL;
@@ -1132,9 +2150,6 @@ ReadListFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 	int arrayIndex = 0;
 	char isListPresent = 0;
 	bool isItemNull = 0;
-	bool typeByValue = false;
-	char typeAlignment = 0;
-	int16 typeLength = 0;
 
 	if (fieldReader->hasPresentBitReader)
 	{
@@ -1163,13 +2178,29 @@ ReadListFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 		return -1;
 	}
 
-	/* allocate enough room for datum array's maximum possible size */
-	datumArray = palloc0(listSize * sizeof(Datum));
-	memset(datumArray, 0, listSize * sizeof(Datum));
+	*isNull = false;
+
+	if (itemReader->kind == FIELD_TYPE__KIND__LIST)
+	{
+		columnValueObject = ReadNestedListItems(listReader, (int) listSize);
+		return PointerGetDatum(columnValueObject);
+	}
+
+	/* fixed width items without nulls don't need to be read as datums */
+	if (listReader->hasFixedWidthItems && !itemReader->hasPresentBitReader && listSize > 0)
+	{
+		columnValueObject = ReadFixedWidthListItems(listReader, (int) listSize);
+		return PointerGetDatum(columnValueObject);
+	}
+
+	/* make enough room for the array's maximum possible size */
+	ListItemArraysEnlarge(listReader, (int) listSize);
 
 	for (arrayIndex = 0; arrayIndex < listSize; ++arrayIndex)
 	{
-		columnValue = ReadPrimitiveFieldAsDatum(itemReader, &isItemNull);
+		ListItemsCopyFromBatchArena(itemReader, listReader->itemValues, NULL, datumArraySize);
+
+		columnValue = ReadFieldAsDatum(itemReader, &isItemNull);
 
 		if (isItemNull)
 		{
@@ -1177,17 +2208,1194 @@ ReadListFieldAsDatum(FieldReader *fieldReader, bool *isNull)
 			continue;
 		}
 
-		datumArray[datumArraySize] = columnValue;
+		listReader->itemValues[datumArraySize] = columnValue;
 		datumArraySize++;
 	}
 
 	/* convert the datum array to PostgreSQL list type */
-	get_typlenbyvalalign(OrcGetPSQLType(itemReader), &typeLength, &typeByValue, &typeAlignment);
-	columnValueObject = construct_array(datumArray, datumArraySize, OrcGetPSQLType(itemReader),
-			typeLength, typeByValue, typeAlignment);
+	columnValueObject = construct_array(listReader->itemValues, datumArraySize,
+			listReader->itemType, listReader->itemTypeLength,
+			listReader->itemTypeByValue, listReader->itemTypeAlignment);
 	columnValue = PointerGetDatum(columnValueObject);
 
-	*isNull = false;
-
 	return columnValue;
 }
+
+
+/*
+ * Builds the array of a list whose items are fixed width numbers without nulls.
+ * Items are written into the array payload as they are decoded; integers are
+ * decoded in batches from the data stream.
+ *
+ * @param itemCount no of items in the list, greater than zero
+ */
+static ArrayType *
+ReadFixedWidthListItems(ListFieldReader *listReader, int itemCount)
+{
+	FieldReader *itemReader = &listReader->itemReader;
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) itemReader->fieldReader;
+	StreamReader *dataReader = &primitiveReader->readers[DATA_STREAM];
+	Oid itemType = listReader->itemType;
+	int arraySize = ARR_OVERHEAD_NONULLS(1) + itemCount * listReader->itemTypeLength;
+	ArrayType *array = (ArrayType *) palloc0(arraySize);
+	char *payload = NULL;
+	int itemIndex = 0;
+
+	SET_VARSIZE(array, arraySize);
+	array->ndim = 1;
+	array->dataoffset = 0;
+	array->elemtype = itemType;
+	ARR_DIMS(array)[0] = itemCount;
+	ARR_LBOUND(array)[0] = 1;
+	payload = ARR_DATA_PTR(array);
+
+	if (itemType == FLOAT4OID || itemType == FLOAT8OID)
+	{
+		for (itemIndex = 0; itemIndex < itemCount; ++itemIndex)
+		{
+			int result = (itemType == FLOAT4OID) ?
+					ReadFloat(dataReader, ((float *) payload) + itemIndex) :
+					ReadDouble(dataReader, ((double *) payload) + itemIndex);
+
+			if (result)
+			{
+				LogError("Error occurred while reading list items");
+			}
+		}
+
+		return array;
+	}
+
+	while (itemIndex < itemCount)
+	{
+		int batchLength = ReadIntegerBatch(itemReader->kind, dataReader, listReader->itemBatch,
+				Min(itemCount - itemIndex, STRING_BATCH_SIZE));
+		int batchIndex = 0;
+
+		if (batchLength <= 0)
+		{
+			LogError("Error occurred while reading list items");
+		}
+
+		switch (itemType)
+		{
+			case INT2OID:
+			{
+				int16 *items = ((int16 *) payload) + itemIndex;
+
+				for (batchIndex = 0; batchIndex < batchLength; ++batchIndex)
+				{
+					items[batchIndex] = (int16) ToSignedIntegerBatch(listReader->itemBatch[batchIndex]);
+				}
+				break;
+			}
+			case INT4OID:
+			{
+				int32 *items = ((int32 *) payload) + itemIndex;
+
+				for (batchIndex = 0; batchIndex < batchLength; ++batchIndex)
+				{
+					items[batchIndex] = (int32) ToSignedIntegerBatch(listReader->itemBatch[batchIndex]);
+				}
+				break;
+			}
+			default:
+			{
+				int64 *items = ((int64 *) payload) + itemIndex;
+
+				for (batchIndex = 0; batchIndex < batchLength; ++batchIndex)
+				{
+					items[batchIndex] = (int64) ToSignedIntegerBatch(listReader->itemBatch[batchIndex]);
+				}
+				break;
+			}
+		}
+
+		itemIndex += batchLength;
+	}
+
+	return array;
+}
+
+
+/*
+ * Builds the multi-dimensional array of a list of lists. Lengths of the nested lists
+ * give the dimensions of the array, and their items are collected into one flat
+ * item array in a single pass. PostgreSQL arrays are rectangular, so nested lists
+ * at the same level must have the same length and can't be null.
+ *
+ * @param listSize no of nested lists in the outermost list
+ */
+static ArrayType *
+ReadNestedListItems(ListFieldReader *listReader, int listSize)
+{
+	int dimensions[MAXDIM];
+	int lowerBounds[MAXDIM];
+	int dimensionCount = 1;
+	int itemCount = 0;
+	int listIndex = 0;
+	int dimensionIndex = 0;
+
+	dimensions[0] = listSize;
+
+	for (listIndex = 0; listIndex < listSize; ++listIndex)
+	{
+		AppendNestedListItems(listReader, &listReader->itemReader, 1, dimensions,
+				&dimensionCount, &itemCount);
+	}
+
+	for (dimensionIndex = 0; dimensionIndex < dimensionCount; ++dimensionIndex)
+	{
+		lowerBounds[dimensionIndex] = 1;
+	}
+
+	return construct_md_array(listReader->itemValues, listReader->itemNulls, dimensionCount,
+			dimensions, lowerBounds, listReader->itemType, listReader->itemTypeLength,
+			listReader->itemTypeByValue, listReader->itemTypeAlignment);
+}
+
+
+/*
+ * Reads the next list at the given nesting level and appends its items to the item
+ * arrays of the outermost list. The first list read at a level sets the length of
+ * that dimension.
+ *
+ * @param rootReader reader of the outermost list
+ * @param fieldReader reader of the nested list
+ * @param depth nesting level of the list, which is also its dimension index
+ * @param dimensions lengths of the dimensions found so far
+ * @param dimensionCount no of dimensions found so far
+ * @param itemCount no of items collected so far
+ */
+static void
+AppendNestedListItems(ListFieldReader *rootReader, FieldReader *fieldReader, int depth,
+		int *dimensions, int *dimensionCount, int *itemCount)
+{
+	ListFieldReader *listReader = (ListFieldReader *) fieldReader->fieldReader;
+	FieldReader *itemReader = &listReader->itemReader;
+	uint64_t listSize = 0;
+	int itemIndex = 0;
+
+	if (fieldReader->hasPresentBitReader)
+	{
+		char isPresent = ReadBoolean(&fieldReader->presentBitReader);
+
+		if (isPresent == 0)
+		{
+			LogError("Null nested lists cannot be read as multi-dimensional arrays");
+		}
+		else if (isPresent < 0)
+		{
+			LogError("Error occurred while reading present bit of list");
+		}
+	}
+
+	if (ReadInteger(fieldReader->kind, &listReader->lengthReader, &listSize))
+	{
+		LogError("Error occurred while reading the length of the list");
+	}
+
+	if (depth == *dimensionCount)
+	{
+		if (depth >= MAXDIM)
+		{
+			LogError2("Nested lists cannot have more than %d levels", MAXDIM);
+		}
+
+		dimensions[depth] = (int) listSize;
+		(*dimensionCount)++;
+	}
+	else if (dimensions[depth] != (int) listSize)
+	{
+		LogError("Nested lists of different lengths cannot be read as multi-dimensional arrays");
+	}
+
+	if (itemReader->kind == FIELD_TYPE__KIND__LIST)
+	{
+		for (itemIndex = 0; itemIndex < listSize; ++itemIndex)
+		{
+			AppendNestedListItems(rootReader, itemReader, depth + 1, dimensions,
+					dimensionCount, itemCount);
+		}
+
+		return;
+	}
+
+	ListItemArraysEnlarge(rootReader, *itemCount + (int) listSize);
+
+	for (itemIndex = 0; itemIndex < listSize; ++itemIndex)
+	{
+		ListItemsCopyFromBatchArena(itemReader, rootReader->itemValues, rootReader->itemNulls,
+				*itemCount);
+
+		rootReader->itemValues[*itemCount] = ReadFieldAsDatum(itemReader,
+				&rootReader->itemNulls[*itemCount]);
+		(*itemCount)++;
+	}
+}
+
+
+/*
+ * Makes sure that the item arrays of the list reader have room for the given number
+ * of items. Arrays keep the memory context they are allocated in.
+ */
+static void
+ListItemArraysEnlarge(ListFieldReader *listReader, int itemCount)
+{
+	if (itemCount <= listReader->itemValuesSize)
+	{
+		return;
+	}
+
+	listReader->itemValuesSize = Max(itemCount, listReader->itemValuesSize * 2);
+	listReader->itemValues = reAllocateMemory(listReader->itemValues,
+			sizeof(Datum) * listReader->itemValuesSize);
+	listReader->itemNulls = reAllocateMemory(listReader->itemNulls,
+			sizeof(bool) * listReader->itemValuesSize);
+}
+
+
+/*
+ * Copies the items of the list being built which point into the batch arena of
+ * the item reader, if reading the next item decodes a new string batch. The
+ * arrays of lists are built after all of their items are read, and the next
+ * batch overwrites or moves the arena under the items read so far.
+ *
+ * @param itemNulls nulls of the items, NULL if null items are not stored
+ * @param itemCount no of items read so far
+ */
+static void
+ListItemsCopyFromBatchArena(FieldReader *itemReader, Datum *itemValues, bool *itemNulls,
+		int itemCount)
+{
+	PrimitiveFieldReader *primitiveReader = NULL;
+	char *arenaStart = NULL;
+	char *arenaEnd = NULL;
+	int itemIndex = 0;
+
+	if (itemReader->kind != FIELD_TYPE__KIND__STRING &&
+			itemReader->kind != FIELD_TYPE__KIND__BINARY)
+	{
+		return;
+	}
+
+	primitiveReader = (PrimitiveFieldReader *) itemReader->fieldReader;
+	if (primitiveReader->batchArena == NULL || primitiveReader->hasDictionary ||
+			primitiveReader->batchPosition < primitiveReader->batchLength)
+	{
+		return;
+	}
+
+	/* items copied at an earlier batch boundary are not in the arena any more */
+	arenaStart = primitiveReader->batchArena;
+	arenaEnd = arenaStart + primitiveReader->batchArenaSize;
+
+	for (itemIndex = 0; itemIndex < itemCount; ++itemIndex)
+	{
+		char *value = NULL;
+		Size valueSize = 0;
+
+		if (itemNulls != NULL && itemNulls[itemIndex])
+		{
+			continue;
+		}
+
+		value = DatumGetPointer(itemValues[itemIndex]);
+		if (value < arenaStart || value >= arenaEnd)
+		{
+			continue;
+		}
+
+		valueSize = VARSIZE(value);
+		itemValues[itemIndex] = PointerGetDatum(memcpy(alloc(valueSize), value, valueSize));
+	}
+}
+
+
+/*
+ * Reads a struct field from the reader and returns it as a composite type Datum.
+ * Sub-fields which are not required in the query are not read and are returned
+ * as nulls.
+ *
+ * @param isNull pointer to store whether the struct is null or not
+ */
+Datum
+ReadStructFieldAsDatum(FieldReader *fieldReader, bool *isNull)
+{
+	StructFieldReader *structReader = (StructFieldReader *) fieldReader->fieldReader;
+	HeapTuple tuple = NULL;
+	int fieldIndex = 0;
+
+	if (fieldReader->hasPresentBitReader)
+	{
+		char isPresent = ReadBoolean(&fieldReader->presentBitReader);
+
+		if (isPresent == 0)
+		{
+			*isNull = true;
+			return 0;
+		}
+		else if (isPresent < 0)
+		{
+			LogError("Error occurred while reading present bit of struct");
+			return -1;
+		}
+	}
+
+	for (fieldIndex = 0; fieldIndex < structReader->noOfFields; ++fieldIndex)
+	{
+		FieldReader *subfield = structReader->fields[fieldIndex];
+
+		if (!subfield->required)
+		{
+			structReader->values[fieldIndex] = 0;
+			structReader->nulls[fieldIndex] = true;
+			continue;
+		}
+
+		structReader->values[fieldIndex] = ReadFieldAsDatum(subfield,
+				&structReader->nulls[fieldIndex]);
+	}
+
+	tuple = heap_form_tuple(structReader->tupleDescriptor, structReader->values,
+			structReader->nulls);
+
+	*isNull = false;
+
+	return HeapTupleGetDatum(tuple);
+}
+
+
+/*
+ * Reads a map field from the reader and returns it as a json object. Keys are
+ * written as json strings and values in their json form. If only some keys are
+ * required, values of the other entries are skipped without being decoded.
+ *
+ * @param isNull pointer to store whether the map is null or not
+ */
+Datum
+ReadMapFieldAsDatum(FieldReader *fieldReader, bool *isNull)
+{
+	MapFieldReader *mapReader = (MapFieldReader *) fieldReader->fieldReader;
+	StringInfo buffer = &mapReader->buffer;
+	uint64_t mapSize = 0;
+	uint64_t entryIndex = 0;
+	bool firstEntry = true;
+
+	if (fieldReader->hasPresentBitReader)
+	{
+		char isPresent = ReadBoolean(&fieldReader->presentBitReader);
+
+		if (isPresent == 0)
+		{
+			*isNull = true;
+			return 0;
+		}
+		else if (isPresent < 0)
+		{
+			LogError("Error occurred while reading present bit of map");
+			return -1;
+		}
+	}
+
+	if (ReadInteger(fieldReader->kind, &mapReader->lengthReader, &mapSize))
+	{
+		LogError("Error occurred while reading the length of the map");
+		return -1;
+	}
+
+	resetStringInfo(buffer);
+	appendStringInfoChar(buffer, '{');
+
+	for (entryIndex = 0; entryIndex < mapSize; ++entryIndex)
+	{
+		bool isKeyNull = false;
+		bool isValueNull = false;
+		Datum key = ReadFieldAsDatum(&mapReader->keyReader, &isKeyNull);
+		Datum value = 0;
+
+		if (isKeyNull || !MapKeyIsRequired(mapReader, DatumGetTextP(key)))
+		{
+			if (SkipFieldValues(&mapReader->valueReader, 1))
+			{
+				LogError("Error occurred while skipping map value");
+			}
+			continue;
+		}
+
+		value = ReadFieldAsDatum(&mapReader->valueReader, &isValueNull);
+
+		if (!firstEntry)
+		{
+			appendStringInfoString(buffer, ", ");
+		}
+		firstEntry = false;
+
+		escape_json(buffer, TextDatumGetCString(key));
+		appendStringInfoString(buffer, " : ");
+
+		if (isValueNull)
+		{
+			appendStringInfoString(buffer, "null");
+		}
+		else
+		{
+			AppendMapValueAsJson(buffer, &mapReader->valueReader, value);
+		}
+	}
+
+	appendStringInfoChar(buffer, '}');
+
+	*isNull = false;
+
+	return PointerGetDatum(cstring_to_text_with_len(buffer->data, buffer->len));
+}
+
+
+/*
+ * Checks if the entry with the given key is used in the query.
+ */
+static bool
+MapKeyIsRequired(MapFieldReader *mapReader, text *key)
+{
+	char *keyData = VARDATA_ANY(key);
+	int keyLength = VARSIZE_ANY_EXHDR(key);
+	int keyIndex = 0;
+
+	if (mapReader->keys == NULL)
+	{
+		return true;
+	}
+
+	for (keyIndex = 0; keyIndex < mapReader->keyCount; ++keyIndex)
+	{
+		char *requiredKey = mapReader->keys[keyIndex];
+
+		if (strlen(requiredKey) == keyLength && memcmp(requiredKey, keyData, keyLength) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ * Appends the json form of a map value to the buffer. Strings are escaped, numbers
+ * and booleans are written as they are. Floating point values which don't have a
+ * json number form, like NaN, are written as strings.
+ */
+static void
+AppendMapValueAsJson(StringInfo buffer, FieldReader *valueReader, Datum value)
+{
+	switch (OrcGetPSQLType(valueReader))
+	{
+		case BOOLOID:
+		{
+			appendStringInfoString(buffer, DatumGetBool(value) ? "true" : "false");
+			break;
+		}
+		case INT2OID:
+		{
+			appendStringInfo(buffer, "%d", (int) DatumGetInt16(value));
+			break;
+		}
+		case INT4OID:
+		{
+			appendStringInfo(buffer, "%d", DatumGetInt32(value));
+			break;
+		}
+		case INT8OID:
+		{
+			appendStringInfo(buffer, INT64_FORMAT, DatumGetInt64(value));
+			break;
+		}
+		case FLOAT4OID:
+		case FLOAT8OID:
+		{
+			double doubleValue = 0;
+			char *valueString = NULL;
+
+			if (OrcGetPSQLType(valueReader) == FLOAT4OID)
+			{
+				doubleValue = DatumGetFloat4(value);
+				valueString = DatumGetCString(DirectFunctionCall1(float4out, value));
+			}
+			else
+			{
+				doubleValue = DatumGetFloat8(value);
+				valueString = DatumGetCString(DirectFunctionCall1(float8out, value));
+			}
+
+			if (isnan(doubleValue) || isinf(doubleValue))
+			{
+				escape_json(buffer, valueString);
+			}
+			else
+			{
+				appendStringInfoString(buffer, valueString);
+			}
+			break;
+		}
+		default:
+		{
+			escape_json(buffer, TextDatumGetCString(value));
+			break;
+		}
+	}
+}
+
+/*
+ * Reads a field of any supported kind and returns it as a Datum, using the read
+ * function chosen for the field in the current stripe.
+ *
+ * @param isNull pointer to store whether the field is null or not
+ */
+Datum
+ReadFieldAsDatum(FieldReader *fieldReader, bool *isNull)
+{
+	return fieldReader->readFunction(fieldReader, isNull);
+}
+
+
+/*
+ * Reads the values of the next rows of a field into the given column vectors. If
+ * a selection vector is given, only the selected rows are read and the others are
+ * skipped without being converted; they are set to null. Direct encoded strings
+ * point into the batch arena of their reader, which is reused when the next
+ * string batch is decoded, so such values are copied into the current memory
+ * context before that happens. All values stay valid until the context is reset.
+ *
+ * @return 0 on success, -1 on error
+ */
+int
+ReadFieldValues(FieldReader *fieldReader, Datum *values, bool *nulls, bool *selection,
+		int rowCount)
+{
+	PrimitiveFieldReader *primitiveReader = NULL;
+	bool hasArenaValues = false;
+	int arenaRowIndex = 0;
+	int rowIndex = 0;
+
+	if (fieldReader->kind == FIELD_TYPE__KIND__STRING ||
+			fieldReader->kind == FIELD_TYPE__KIND__BINARY)
+	{
+		primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+		hasArenaValues = (primitiveReader->batchArena != NULL &&
+				!primitiveReader->hasDictionary);
+	}
+
+	while (rowIndex < rowCount)
+	{
+		if (selection != NULL && !selection[rowIndex])
+		{
+			int skipCount = 0;
+
+			/* skipping passes over the rest of the string batch without decoding another */
+			while (rowIndex + skipCount < rowCount && !selection[rowIndex + skipCount])
+			{
+				values[rowIndex + skipCount] = (Datum) 0;
+				nulls[rowIndex + skipCount] = true;
+				skipCount++;
+			}
+
+			if (SkipFieldValues(fieldReader, skipCount))
+			{
+				return -1;
+			}
+
+			rowIndex += skipCount;
+			continue;
+		}
+
+		/* the next value may decode a new string batch into the arena */
+		if (hasArenaValues && primitiveReader->batchPosition >= primitiveReader->batchLength)
+		{
+			for (; arenaRowIndex < rowIndex; ++arenaRowIndex)
+			{
+				char *value = NULL;
+				Size valueSize = 0;
+
+				if (nulls[arenaRowIndex])
+				{
+					continue;
+				}
+
+				value = DatumGetPointer(values[arenaRowIndex]);
+				valueSize = VARSIZE(value);
+
+				values[arenaRowIndex] = PointerGetDatum(memcpy(alloc(valueSize), value,
+						valueSize));
+			}
+		}
+
+		values[rowIndex] = fieldReader->readFunction(fieldReader, &nulls[rowIndex]);
+		rowIndex++;
+	}
+
+	return 0;
+}
+
+
+/*
+ * Reads the present bit of a field with a present stream.
+ *
+ * @return true if the value is present, false if it is null
+ */
+static inline bool
+ReadPresentBit(FieldReader *fieldReader, bool *isNull)
+{
+	char isPresent = ReadBoolean(&fieldReader->presentBitReader);
+
+	if (isPresent < 0)
+	{
+		LogError("Error occurred while reading present bit stream");
+	}
+
+	*isNull = (isPresent == 0);
+
+	return !(*isNull);
+}
+
+
+/*
+ * Value readers for the common column types. Each one reads a present value for a
+ * fixed combination of ORC kind, PostgreSQL type and encoding, so they don't check
+ * any of them. They are wrapped into the read functions defined below.
+ */
+static inline Datum
+ReadBooleanValue(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	char value = ReadBoolean(&primitiveReader->readers[DATA_STREAM]);
+
+	if (value < 0)
+	{
+		LogError("Error occurred while reading column");
+	}
+
+	return BoolGetDatum(value);
+}
+
+
+static inline int64
+ReadSignedIntegerValue(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	uint64_t value = 0;
+
+	/* all signed integer kinds are read the same way */
+	if (ReadInteger(FIELD_TYPE__KIND__LONG, &primitiveReader->readers[DATA_STREAM], &value))
+	{
+		LogError("Error occurred while reading column");
+	}
+
+	return ToSignedIntegerBatch(value);
+}
+
+
+static inline Datum
+ReadInt16Value(FieldReader *fieldReader)
+{
+	return Int16GetDatum((int16) ReadSignedIntegerValue(fieldReader));
+}
+
+
+static inline Datum
+ReadInt32Value(FieldReader *fieldReader)
+{
+	return Int32GetDatum((int32) ReadSignedIntegerValue(fieldReader));
+}
+
+
+static inline Datum
+ReadInt64Value(FieldReader *fieldReader)
+{
+	return Int64GetDatum(ReadSignedIntegerValue(fieldReader));
+}
+
+
+static inline Datum
+ReadFloat4Value(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	float value = 0;
+
+	if (ReadFloat(&primitiveReader->readers[DATA_STREAM], &value))
+	{
+		LogError("Error occurred while reading column");
+	}
+
+	return Float4GetDatum(value);
+}
+
+
+static inline Datum
+ReadFloat8Value(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	double value = 0;
+
+	if (ReadDouble(&primitiveReader->readers[DATA_STREAM], &value))
+	{
+		LogError("Error occurred while reading column");
+	}
+
+	return Float8GetDatum(value);
+}
+
+
+static inline Datum
+ReadDictionaryStringValue(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	uint64_t dictionaryIndex = 0;
+
+	if (!primitiveReader->dictionaryLoaded)
+	{
+		FillDictionary(fieldReader);
+	}
+
+	if (ReadInteger(FIELD_TYPE__KIND__STRING, &primitiveReader->readers[DATA_STREAM],
+			&dictionaryIndex) || dictionaryIndex >= primitiveReader->dictionarySize)
+	{
+		LogError("Dictionary item position is out of range");
+	}
+
+	return PointerGetDatum(primitiveReader->dictionaryArena +
+			primitiveReader->dictionaryOffsets[dictionaryIndex]);
+}
+
+
+/* defines the value reader of a type decoded in batches with the given fill function */
+#define DEFINE_BATCH_VALUE_READER(valueReaderName, fillFunction) \
+static inline Datum \
+valueReaderName(FieldReader *fieldReader) \
+{ \
+	PrimitiveFieldReader *primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader; \
+\
+	if (primitiveReader->batchPosition >= primitiveReader->batchLength && \
+			fillFunction(fieldReader)) \
+	{ \
+		LogError("Error occurred while reading column"); \
+	} \
+\
+	return primitiveReader->batchValues[primitiveReader->batchPosition++]; \
+}
+
+DEFINE_BATCH_VALUE_READER(ReadStringBatchValue, FillStringBatch)
+DEFINE_BATCH_VALUE_READER(ReadDateBatchValue, FillDateBatch)
+DEFINE_BATCH_VALUE_READER(ReadTimestampBatchValue, FillTimestampBatch)
+
+
+static inline Datum
+ReadDecimalValue(FieldReader *fieldReader)
+{
+	Datum value = 0;
+
+	if (ReadDecimal(fieldReader, &value))
+	{
+		LogError("Error occurred while reading column");
+	}
+
+	return value;
+}
+
+
+/*
+ * Defines two read functions for the given value reader; one for the stripes where
+ * the field has a present stream, and one for the stripes where it doesn't.
+ */
+#define DEFINE_READ_FUNCTIONS(valueReaderName) \
+static Datum \
+valueReaderName##WithNulls(FieldReader *fieldReader, bool *isNull) \
+{ \
+	if (!ReadPresentBit(fieldReader, isNull)) \
+	{ \
+		return 0; \
+	} \
+\
+	return valueReaderName(fieldReader); \
+} \
+\
+static Datum \
+valueReaderName##WithoutNulls(FieldReader *fieldReader, bool *isNull) \
+{ \
+	*isNull = false; \
+	return valueReaderName(fieldReader); \
+}
+
+DEFINE_READ_FUNCTIONS(ReadBooleanValue)
+DEFINE_READ_FUNCTIONS(ReadInt16Value)
+DEFINE_READ_FUNCTIONS(ReadInt32Value)
+DEFINE_READ_FUNCTIONS(ReadInt64Value)
+DEFINE_READ_FUNCTIONS(ReadFloat4Value)
+DEFINE_READ_FUNCTIONS(ReadFloat8Value)
+DEFINE_READ_FUNCTIONS(ReadDictionaryStringValue)
+DEFINE_READ_FUNCTIONS(ReadStringBatchValue)
+DEFINE_READ_FUNCTIONS(ReadDateBatchValue)
+DEFINE_READ_FUNCTIONS(ReadTimestampBatchValue)
+DEFINE_READ_FUNCTIONS(ReadDecimalValue)
+
+/* picks the variant of the read functions for the field's present stream */
+#define READ_FUNCTION(fieldReader, valueReaderName) \
+	((fieldReader)->hasPresentBitReader ? valueReaderName##WithNulls : valueReaderName##WithoutNulls)
+
+
+/*
+ * Chooses the read functions of the field and its required sub-fields for the
+ * current stripe. Types without a specialized read function are read with the
+ * generic ReadPrimitiveFieldAsDatum.
+ */
+void
+FieldReaderSetReadFunction(FieldReader *fieldReader)
+{
+	PrimitiveFieldReader *primitiveReader = NULL;
+
+	switch (fieldReader->kind)
+	{
+		case FIELD_TYPE__KIND__STRUCT:
+		{
+			StructFieldReader *structReader = (StructFieldReader *) fieldReader->fieldReader;
+			int fieldIndex = 0;
+
+			for (fieldIndex = 0; fieldIndex < structReader->noOfFields; ++fieldIndex)
+			{
+				if (structReader->fields[fieldIndex]->required)
+				{
+					FieldReaderSetReadFunction(structReader->fields[fieldIndex]);
+				}
+			}
+
+			fieldReader->readFunction = ReadStructFieldAsDatum;
+			return;
+		}
+		case FIELD_TYPE__KIND__LIST:
+		{
+			FieldReaderSetReadFunction(&((ListFieldReader *) fieldReader->fieldReader)->itemReader);
+			fieldReader->readFunction = ReadListFieldAsDatum;
+			return;
+		}
+		case FIELD_TYPE__KIND__MAP:
+		{
+			MapFieldReader *mapReader = (MapFieldReader *) fieldReader->fieldReader;
+
+			FieldReaderSetReadFunction(&mapReader->keyReader);
+			FieldReaderSetReadFunction(&mapReader->valueReader);
+			fieldReader->readFunction = ReadMapFieldAsDatum;
+			return;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	primitiveReader = (PrimitiveFieldReader *) fieldReader->fieldReader;
+	fieldReader->readFunction = ReadPrimitiveFieldAsDatum;
+
+	switch (OrcGetPSQLType(fieldReader))
+	{
+		case BOOLOID:
+		{
+			fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadBooleanValue);
+			break;
+		}
+		case INT2OID:
+		{
+			fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadInt16Value);
+			break;
+		}
+		case INT4OID:
+		{
+			fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadInt32Value);
+			break;
+		}
+		case INT8OID:
+		{
+			fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadInt64Value);
+			break;
+		}
+		case FLOAT4OID:
+		{
+			if (fieldReader->kind == FIELD_TYPE__KIND__FLOAT)
+			{
+				fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadFloat4Value);
+			}
+			break;
+		}
+		case FLOAT8OID:
+		{
+			if (fieldReader->kind == FIELD_TYPE__KIND__DOUBLE)
+			{
+				fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadFloat8Value);
+			}
+			break;
+		}
+		case BPCHAROID:
+		case VARCHAROID:
+		case TEXTOID:
+		{
+			if (primitiveReader->hasDictionary)
+			{
+				fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadDictionaryStringValue);
+			}
+			else if (primitiveReader->batchValues != NULL)
+			{
+				fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadStringBatchValue);
+			}
+			break;
+		}
+		case DATEOID:
+		{
+			if (primitiveReader->batchValues != NULL)
+			{
+				fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadDateBatchValue);
+			}
+			break;
+		}
+		case TIMESTAMPOID:
+		{
+			if (primitiveReader->batchValues != NULL)
+			{
+				fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadTimestampBatchValue);
+			}
+			break;
+		}
+		case NUMERICOID:
+		{
+			fieldReader->readFunction = READ_FUNCTION(fieldReader, ReadDecimalValue);
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+
+static Datum
+ReadStrideConstant(FieldReader *fieldReader, bool *isNull)
+{
+	*isNull = false;
+	return fieldReader->strideConstant;
+}
+
+
+static Datum
+ReadStrideNull(FieldReader *fieldReader, bool *isNull)
+{
+	*isNull = true;
+	return 0;
+}
+
+
+/*
+ * Converts the statistics of a stride into the value of the field if all of its
+ * values are the same. Only the types whose statistics hold their exact values are
+ * considered.
+ *
+ * @return true if the constant value is found, false otherwise
+ */
+static bool
+StrideConstantValue(FieldReader *fieldReader, ColumnStatistics *statistics, Datum *value)
+{
+	switch (OrcGetPSQLType(fieldReader))
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		{
+			IntegerStatistics *intStatistics = statistics->intstatistics;
+
+			if (intStatistics == NULL || !intStatistics->has_minimum ||
+					!intStatistics->has_maximum || intStatistics->minimum != intStatistics->maximum)
+			{
+				return false;
+			}
+
+			switch (OrcGetPSQLType(fieldReader))
+			{
+				case INT2OID:
+					*value = Int16GetDatum((int16) intStatistics->minimum);
+					break;
+				case INT4OID:
+					*value = Int32GetDatum((int32) intStatistics->minimum);
+					break;
+				default:
+					*value = Int64GetDatum(intStatistics->minimum);
+					break;
+			}
+			return true;
+		}
+		case FLOAT4OID:
+		case FLOAT8OID:
+		{
+			DoubleStatistics *doubleStatistics = statistics->doublestatistics;
+
+			/*
+			 * Writers update the bounds with < and >, so a stride whose first value
+			 * is NaN, or which has both -0 and 0, has equal bounds without being
+			 * constant.
+			 */
+			if (doubleStatistics == NULL || !doubleStatistics->has_minimum ||
+					!doubleStatistics->has_maximum || isnan(doubleStatistics->minimum) ||
+					doubleStatistics->minimum == 0 ||
+					doubleStatistics->minimum != doubleStatistics->maximum)
+			{
+				return false;
+			}
+
+			if (OrcGetPSQLType(fieldReader) == FLOAT4OID)
+			{
+				*value = Float4GetDatum((float) doubleStatistics->minimum);
+			}
+			else
+			{
+				*value = Float8GetDatum(doubleStatistics->minimum);
+			}
+			return true;
+		}
+		case BPCHAROID:
+		case VARCHAROID:
+		case TEXTOID:
+		{
+			StringStatistics *stringStatistics = statistics->stringstatistics;
+
+			if (stringStatistics == NULL || stringStatistics->minimum == NULL ||
+					stringStatistics->maximum == NULL ||
+					strcmp(stringStatistics->minimum, stringStatistics->maximum) != 0)
+			{
+				return false;
+			}
+
+			*value = CStringGetStringDatum(fieldReader, stringStatistics->minimum);
+			return true;
+		}
+		case DATEOID:
+		{
+			DateStatistics *dateStatistics = statistics->datestatistics;
+
+			if (dateStatistics == NULL || !dateStatistics->has_minimum ||
+					!dateStatistics->has_maximum || dateStatistics->minimum != dateStatistics->maximum)
+			{
+				return false;
+			}
+
+			*value = DateADTGetDatum(dateStatistics->minimum - ORC_PSQL_EPOCH_IN_DAYS);
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+
+/*
+ * Sets how a primitive field is read in the given stride using the statistics in
+ * its row index. If the stride has no values, nulls are returned for it. If it has
+ * no nulls, its present bits are passed over; and if its values are also all the
+ * same, that value is returned without reading its data streams. The field must
+ * be at the start of the stride, and its memory context must outlive the stride.
+ *
+ * @param strideIndex index of the stride in the stripe
+ * @param strideRowCount no of rows in the stride
+ */
+void
+FieldReaderSetStrideMode(FieldReader *fieldReader, int strideIndex, long strideRowCount)
+{
+	RowIndex *rowIndex = fieldReader->rowIndex;
+	ColumnStatistics *statistics = NULL;
+	Datum constant = 0;
+
+	FieldReaderClearStrideMode(fieldReader);
+	FieldReaderSetReadFunction(fieldReader);
+
+	if (IsComplexType(fieldReader->kind) || rowIndex == NULL || strideIndex >= rowIndex->n_entry)
+	{
+		return;
+	}
+
+	statistics = rowIndex->entry[strideIndex]->statistics;
+	if (statistics == NULL || !statistics->has_numberofvalues)
+	{
+		return;
+	}
+
+	if (statistics->numberofvalues == 0)
+	{
+		if (SkipFieldValues(fieldReader, strideRowCount))
+		{
+			LogError("Error occurred while skipping null stride");
+		}
+
+		fieldReader->strideMode = STRIDE_MODE_ALL_NULLS;
+		fieldReader->readFunction = ReadStrideNull;
+	}
+	else if (statistics->numberofvalues == strideRowCount)
+	{
+		if (StrideConstantValue(fieldReader, statistics, &constant))
+		{
+			if (SkipFieldValues(fieldReader, strideRowCount))
+			{
+				LogError("Error occurred while skipping constant stride");
+			}
+
+			fieldReader->strideMode = STRIDE_MODE_CONSTANT;
+			fieldReader->strideConstant = constant;
+			fieldReader->readFunction = ReadStrideConstant;
+		}
+		else if (fieldReader->hasPresentBitReader)
+		{
+			if (SkipBooleans(&fieldReader->presentBitReader, strideRowCount))
+			{
+				LogError("Error occurred while skipping present bits");
+			}
+
+			/* the field is read as if it has no present stream until the stride ends */
+			fieldReader->hasPresentBitReader = 0;
+			fieldReader->strideMode = STRIDE_MODE_NO_NULLS;
+			FieldReaderSetReadFunction(fieldReader);
+		}
+	}
+}
+
+
+/*
+ * Takes the field back to the normal mode. Its read function should be set again
+ * by the caller.
+ */
+void
+FieldReaderClearStrideMode(FieldReader *fieldReader)
+{
+	switch (fieldReader->strideMode)
+	{
+		case STRIDE_MODE_NO_NULLS:
+		{
+			fieldReader->hasPresentBitReader = 1;
+			break;
+		}
+		case STRIDE_MODE_CONSTANT:
+		{
+			PrimitiveFieldReader *primitiveReader =
+					(PrimitiveFieldReader *) fieldReader->fieldReader;
+
+			if (!primitiveReader->valueByValue)
+			{
+				freeMemory(DatumGetPointer(fieldReader->strideConstant));
+			}
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	fieldReader->strideMode = STRIDE_MODE_NORMAL;
+	fieldReader->strideConstant = 0;
+}
@@ -9,6 +9,8 @@
 #define RECORDREADER_H_
 
 #include "postgres.h"
+#include "access/tupdesc.h"
+#include "lib/stringinfo.h"
 #include "nodes/primnodes.h"
 
 #include "orc.pb-c.h"
@@ -24,10 +26,14 @@
 #define STRING_DIRECT_STREAM_COUNT	2
 #define TIMESTAMP_STREAM_COUNT		2
 #define BINARY_STREAM_COUNT			2
+#define DECIMAL_STREAM_COUNT		2
 #define COMMON_STREAM_COUNT			1
 
 #define MAX_POSTSCRIPT_SIZE		255
-#define DEFAULT_DICTIONARY_ITEM_LENGTH    255
+
+/* no of direct encoded strings, dates or timestamps decoded at once */
+#define STRING_BATCH_SIZE				1024
+#define DEFAULT_STRING_BATCH_ARENA_SIZE	65536
 
 /* timestamp related values */
 #define SECONDS_PER_DAY					86400
@@ -38,6 +44,14 @@
 #define ORC_DIFF_POSTGRESQL				473385600L
 #define ORC_PSQL_EPOCH_IN_DAYS			10957
 
+/* decimal related values, NUMERIC_* values are the same as in PostgreSQL's numeric.c */
+#define NUMERIC_BASE_DIGITS				4
+#define NUMERIC_POSITIVE				0x0000
+#define NUMERIC_NEGATIVE				0x4000
+#define MAX_DECIMAL_BASE_DIGITS			64
+#define DECIMAL_CHUNK_BASE				1000000000000000000ULL
+#define DECIMAL_CHUNK_DIGITS			18
+
 /*
  * The conversion from signed integer to ORC format is as follows:
  * 0, -1, 1, -2, 2, -3, 3, ......  --> 0, 1, 2, 3, 4, 5, 6, ...
@@ -48,8 +62,13 @@
 #define ToUnsignedInteger(x) (uint64_t)( ((x) < 0) ? ( ((uint64_t)-(x+1)) * 2 + 1) : (2 * (uint64_t)(x)))
 #define ToSignedInteger(x)   ( int64_t)( ((x) % 2) ? (-(int64_t)((x - 1) / 2) - 1) : ((x) / 2) )
 
+/* branch free form of ToSignedInteger for unsigned 64 bit values, used in batch loops */
+#define ToSignedIntegerBatch(x) ((int64_t) ((x) >> 1) ^ -(int64_t) ((x) & 1))
+
 #define IsComplexType(type) (type == FIELD_TYPE__KIND__LIST || type == FIELD_TYPE__KIND__STRUCT || type == FIELD_TYPE__KIND__MAP)
 
+#define DEFAULT_LIST_ITEM_COUNT	64
+
 
 typedef enum
 {
@@ -57,6 +76,17 @@ typedef enum
 } EncodingType;
 
 
+/*
+ * How a column is read in the current stride, decided by the statistics in its row
+ * index. In the constant and all null modes the streams of the stride are already
+ * passed over; in the no nulls mode only its present bits are.
+ */
+typedef enum
+{
+	STRIDE_MODE_NORMAL, STRIDE_MODE_NO_NULLS, STRIDE_MODE_CONSTANT, STRIDE_MODE_ALL_NULLS
+} StrideMode;
+
+
 typedef struct
 {
 	/* stream to read from the file */
@@ -87,7 +117,7 @@ typedef struct
  * Base structure to represent a field reader.
  * Its fieldreader variable contains the streams of the type.
  */
-typedef struct
+typedef struct FieldReader
 {
 	StreamReader presentBitReader;
 	FieldType__Kind kind;
@@ -104,6 +134,17 @@ typedef struct
 
 	/* psql column information */
 	Var* psqlVariable;
+
+	/*
+	 * Function to read the next value of the field. It is chosen for each stripe by
+	 * FieldReaderSetReadFunction, so checks which don't change in a stripe are not
+	 * repeated for each value.
+	 */
+	Datum (*readFunction)(struct FieldReader *fieldReader, bool *isNull);
+
+	/* mode of the current stride and the value of the column in constant mode */
+	StrideMode strideMode;
+	Datum strideConstant;
 } FieldReader;
 
 
@@ -116,28 +157,100 @@ typedef struct
 	StreamReader readers[MAX_STREAM_COUNT];
 	ColumnEncoding__Kind encoding;
 
-	/* for string type to store the dictionary */
+	/*
+	 * For string type to store the dictionary. Items are kept as ready-made
+	 * text/varchar/bpchar datums back to back in one arena, and are referred by
+	 * their offsets in the arena. Dictionary is loaded on the first read.
+	 */
 	char hasDictionary;
+	char dictionaryLoaded;
 	int dictionarySize;
-	int *wordLength;
-	char **dictionary;
+	int *dictionaryOffsets;
+	char *dictionaryArena;
+	long dictionaryArenaSize;
+
+	/*
+	 * Direct encoded strings, dates and timestamps are decoded in batches. Strings
+	 * of the current batch are varlena datums in one arena which is reused by the
+	 * next batch. Nanoseconds of timestamps are first decoded into the secondary
+	 * values. batchValues is NULL if the column is not decoded in batches.
+	 */
+	Datum *batchValues;
+	int batchLength;
+	int batchPosition;
+	char *batchArena;
+	long batchArenaSize;
+	uint64_t *batchSecondaryValues;
+
+	/*
+	 * Length limit of CHAR(n) and VARCHAR(n) columns in characters, -1 for other
+	 * types. Strings are checked and padded against it without the type's input
+	 * function unless they may be too long.
+	 */
+	int stringMaxLength;
+	char stringPadded;
+	char singleByteEncoding;
+
+	/* whether values of the column's type are passed by value, looked up once */
+	bool valueByValue;
 } PrimitiveFieldReader;
 
 
 /*
- * Reader for list types.
+ * Reader for list types. Type information of the items is looked up once when the
+ * reader is allocated, and the item value array is reused by the following lists.
+ * Fixed width items without nulls are decoded straight into the array payload.
+ * Nested lists are read as multi-dimensional arrays, their items are collected in
+ * the item arrays of the outermost list.
  */
 typedef struct
 {
 	StreamReader lengthReader;
 	FieldReader itemReader;
+
+	Oid itemType;
+	int16 itemTypeLength;
+	bool itemTypeByValue;
+	char itemTypeAlignment;
+	char hasFixedWidthItems;
+
+	Datum *itemValues;
+	bool *itemNulls;
+	int itemValuesSize;
+	uint64_t *itemBatch;
 } ListFieldReader;
 
 
+/*
+ * Reader for map types. Maps are read as json objects, which are written into the
+ * buffer directly from the key and value streams. If only some keys of the map are
+ * used in the query, the other entries are skipped and left out of the object.
+ */
+typedef struct
+{
+	StreamReader lengthReader;
+	FieldReader keyReader;
+	FieldReader valueReader;
+
+	int keyCount;
+	char **keys;
+	StringInfoData buffer;
+} MapFieldReader;
+
+
+/*
+ * Reader for struct types. The row itself is also read by a struct reader, other
+ * struct fields are read as composite types using their tuple descriptor and value
+ * arrays.
+ */
 typedef struct
 {
 	int noOfFields;
 	FieldReader **fields;
+
+	TupleDesc tupleDescriptor;
+	Datum *values;
+	bool *nulls;
 } StructFieldReader;
 
 
@@ -156,6 +269,15 @@ void FillDictionary(FieldReader* stringFieldReader);
  */
 Datum ReadPrimitiveFieldAsDatum(FieldReader *fieldReader, bool *isNull);
 Datum ReadListFieldAsDatum(FieldReader *fieldReader, bool *isNull);
+Datum ReadStructFieldAsDatum(FieldReader *fieldReader, bool *isNull);
+Datum ReadMapFieldAsDatum(FieldReader *fieldReader, bool *isNull);
+Datum ReadFieldAsDatum(FieldReader *fieldReader, bool *isNull);
+int ReadFieldValues(FieldReader *fieldReader, Datum *values, bool *nulls, bool *selection,
+		int rowCount);
+int SkipFieldValues(FieldReader *fieldReader, long rowCount);
+void FieldReaderSetReadFunction(FieldReader *fieldReader);
+void FieldReaderSetStrideMode(FieldReader *fieldReader, int strideIndex, long strideRowCount);
+void FieldReaderClearStrideMode(FieldReader *fieldReader);
 
 
 /**